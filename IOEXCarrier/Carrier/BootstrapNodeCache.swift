@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A scored cache of bootstrap nodes that recently led carrier node to
+/// connect, persisted under the persistent location of carrier node.
+///
+/// Nodes are credited only when the connection status callback reports
+/// carrier node connected. The native node does not report which DHT peer
+/// answered, so a connection is the finest signal available: a node is
+/// confirmed by a run that connected while it was in the bootstrap list,
+/// and misses a run that did not connect in time. Entries not confirmed
+/// within `MAX_AGE`, or missing `MAX_MISSES` runs in a row, are removed,
+/// so nodes that stopped answering do not keep their credit.
+internal final class BootstrapNodeCache {
+
+    private static let TAG: String = "BootstrapNodeCache"
+    private static let FILE_NAME: String = "bootstrap_cache.plist"
+    private static let MAX_NODES: Int = 16
+    private static let MAX_AGE: TimeInterval = 7 * 24 * 3600
+    private static let MAX_MISSES: Int = 3
+
+    private final class Entry {
+        let node: BootstrapNode
+        var score: Int
+        var lastGood: Date
+        var misses: Int
+
+        init(_ node: BootstrapNode, _ score: Int, _ lastGood: Date, _ misses: Int = 0) {
+            self.node = node
+            self.score = score
+            self.lastGood = lastGood
+            self.misses = misses
+        }
+
+        var key: String {
+            return "\(node.publicKey ?? "")@\(node.ipv4 ?? node.ipv6 ?? ""):\(node.port ?? "")"
+        }
+    }
+
+    private let path: String
+    private var entries: [String: Entry]
+    private var inUse: [BootstrapNode]
+    private var didConnect: Bool
+    private var didFail: Bool
+
+    internal init(_ persistentLocation: String) {
+        path = (persistentLocation as NSString)
+            .appendingPathComponent(BootstrapNodeCache.FILE_NAME)
+        entries = [String: Entry]()
+        inUse = [BootstrapNode]()
+        didConnect = false
+        didFail = false
+        load()
+    }
+
+    /// Merge cached nodes with configured ones, best cached nodes first.
+    internal func bootstrapNodes(with configured: [BootstrapNode]) -> [BootstrapNode] {
+        let now = Date()
+        let count = entries.count
+        for (key, entry) in entries where isStale(entry, now) {
+            entries[key] = nil
+        }
+        if entries.count < count {
+            save()
+        }
+
+        let cached = entries.values.filter {
+            $0.score > 0
+        }.sorted {
+            $0.score != $1.score ? $0.score > $1.score : $0.lastGood > $1.lastGood
+        }
+
+        var keys = Set<String>()
+        var nodes = [BootstrapNode]()
+
+        for entry in cached.prefix(BootstrapNodeCache.MAX_NODES) {
+            keys.insert(entry.key)
+            nodes.append(entry.node)
+        }
+
+        for node in configured {
+            let key = Entry(node, 0, now).key
+            if !keys.contains(key) {
+                keys.insert(key)
+                nodes.append(node)
+            }
+        }
+
+        inUse = nodes
+        return nodes
+    }
+
+    /// Confirm the nodes of current run when the connection status
+    /// callback reports carrier node connected.
+    internal func recordConnected() {
+        guard !didConnect && !didFail else {
+            return
+        }
+        didConnect = true
+
+        let now = Date()
+        for node in inUse {
+            let key = Entry(node, 0, now).key
+            if let entry = entries[key] {
+                entry.score = min(entry.score + 1, 100)
+                entry.lastGood = now
+                entry.misses = 0
+            } else {
+                entries[key] = Entry(node, 1, now)
+            }
+        }
+
+        save()
+    }
+
+    /// Penalize the cached nodes of current run if carrier node did not
+    /// connect in time, and remove the ones missing too many runs.
+    internal func recordFailure() {
+        guard !didConnect && !didFail else {
+            return
+        }
+        didFail = true
+
+        let now = Date()
+        for node in inUse {
+            let key = Entry(node, 0, now).key
+            guard let entry = entries[key] else {
+                continue
+            }
+
+            entry.score = max(0, entry.score - 1)
+            entry.misses += 1
+            if isStale(entry, now) {
+                entries[key] = nil
+            }
+        }
+
+        save()
+    }
+
+    private func isStale(_ entry: Entry, _ now: Date) -> Bool {
+        return entry.misses >= BootstrapNodeCache.MAX_MISSES ||
+            now.timeIntervalSince(entry.lastGood) >= BootstrapNodeCache.MAX_AGE
+    }
+
+    private func load() {
+        guard let data = FileManager.default.contents(atPath: path),
+            let plist = try? PropertyListSerialization.propertyList(from: data,
+                                                                    options: [],
+                                                                    format: nil),
+            let items = plist as? [[String: Any]] else {
+            return
+        }
+
+        for item in items {
+            let node = BootstrapNode()
+            node.ipv4 = item["ipv4"] as? String
+            node.ipv6 = item["ipv6"] as? String
+            node.port = item["port"] as? String
+            node.publicKey = item["publicKey"] as? String
+
+            let score = item["score"] as? Int ?? 0
+            let lastGood = item["lastGood"] as? Date ?? Date.distantPast
+            let misses = item["misses"] as? Int ?? 0
+            let entry = Entry(node, score, lastGood, misses)
+            entries[entry.key] = entry
+        }
+    }
+
+    private func save() {
+        var items = [[String: Any]]()
+
+        for entry in entries.values {
+            var item = [String: Any]()
+            item["ipv4"] = entry.node.ipv4
+            item["ipv6"] = entry.node.ipv6
+            item["port"] = entry.node.port
+            item["publicKey"] = entry.node.publicKey
+            item["score"] = entry.score
+            item["lastGood"] = entry.lastGood
+            item["misses"] = entry.misses
+            items.append(item)
+        }
+
+        do {
+            let data = try PropertyListSerialization.data(fromPropertyList: items,
+                                                          format: .binary,
+                                                          options: 0)
+            try data.write(to: URL(fileURLWithPath: path), options: .atomic)
+        } catch {
+            Log.w(BootstrapNodeCache.TAG, "Save bootstrap node cache error: \(error)")
+        }
+    }
+}
@@ -52,9 +52,12 @@ func getCarrier(_ cctxt: UnsafeMutableRawPointer) -> Carrier {
 private func onIdle(_: OpaquePointer?, cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
+    carrier.markStartup(.LoopStarted)
 
-    handler.willBecomeIdle?(carrier)
+    carrier.drainCommands()
+    carrier.runTimers()
+    carrier.delegate?.willBecomeIdle?(carrier)
+    carrier.loopWillSleep()
 }
 
 private func onConnection(_: OpaquePointer?, cstatus: UInt32,
@@ -62,17 +65,21 @@ private func onConnection(_: OpaquePointer?, cstatus: UInt32,
 
     let carrier = getCarrier(cctxt!)
     let status  = CarrierConnectionStatus(rawValue: Int(cstatus))!
-    let handler = carrier.delegate!
 
-    handler.connectionStatusDidChange?(carrier, status)
+    if status == .Connected {
+        carrier.markStartup(.Connected)
+        carrier.bootstrapDidConnect()
+    }
+
+    carrier.notifyDelegate(.ConnectionStatus(status))
 }
 
 private func onReady(_: OpaquePointer?, cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
+    carrier.markStartup(.Ready)
 
-    handler.didBecomeReady(carrier)
+    carrier.notifyDelegate(.Ready)
 }
 
 private func onSelfInfoChanged(_: OpaquePointer?,
@@ -80,12 +87,11 @@ private func onSelfInfoChanged(_: OpaquePointer?,
                                cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
     let cUserInfo = cinfo!.assumingMemoryBound(to: CUserInfo.self).pointee
     let info = convertCUserInfoToCarrierUserInfo(cUserInfo)
 
-    handler.selfUserInfoDidChange?(carrier, info)
+    carrier.notifyDelegate(.SelfUserInfo(info))
 }
 
 private func onFriendIterated(_: OpaquePointer?,
@@ -93,15 +99,18 @@ private func onFriendIterated(_: OpaquePointer?,
                               cctxt: UnsafeMutableRawPointer?) -> CBool {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
     if (cinfo != nil) {
         let cFriendInfo = cinfo!.assumingMemoryBound(to: CFriendInfo.self).pointee
         let info = convertCFriendInfoToCarrierFriendInfo(cFriendInfo)
+        carrier.friendStore.update(info)
         carrier.friends.append(info)
     } else {
-        handler.didReceiveFriendsList?(carrier, carrier.friends)
+        let friends = carrier.friends
         carrier.friends.removeAll()
+        carrier.friendStore.markLoaded()
+
+        carrier.notifyDelegate(.FriendsList(friends))
     }
 
     return true
@@ -113,12 +122,30 @@ private func onFriendConnectionChanged(_: OpaquePointer?,
                                        cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
-    let friendId = String(cString: cfriendId!)
+    let (handle, friendId) = carrier.friendTable.intern(cfriendId!)
     let status = CarrierConnectionStatus(rawValue: Int(cstatus))!
 
-    handler.friendConnectionDidChange?(carrier, friendId, status)
+    if status == .Connected {
+        carrier.markStartup(.FriendConnected)
+    }
+
+    if status == .Disconnected {
+        carrier.reassembler.remove(handle)
+    }
+
+    let oldStatus = carrier.friendStore.status(of: friendId)
+    carrier.friendStore.updateStatus(friendId, status)
+
+    if status == .Connected {
+        carrier.flushOutbound(friendId)
+    }
+
+    if carrier.coalesce(friendId, handle, oldStatus: oldStatus, status: status) {
+        return
+    }
+
+    carrier.notifyDelegate(.FriendConnection(handle, friendId, status))
 }
 
 private func onFriendInfoChanged(_: OpaquePointer?,
@@ -127,13 +154,13 @@ private func onFriendInfoChanged(_: OpaquePointer?,
                                  cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
-    let friendId = String(cString: cfriendId!)
+    let friendId = carrier.friendTable.intern(cfriendId!).id
     let cFriendInfo = cinfo!.assumingMemoryBound(to: CFriendInfo.self).pointee
-    let info = convertCFriendInfoToCarrierFriendInfo(cFriendInfo)
+    let view = CarrierFriendInfoView(cFriendInfo)
+    carrier.friendStore.update(view)
 
-    handler.friendInfoDidChange?(carrier,friendId, info)
+    carrier.notifyDelegate(.FriendInfo(friendId, view))
 }
 
 private func onFriendPresence(_: OpaquePointer?,
@@ -142,12 +169,18 @@ private func onFriendPresence(_: OpaquePointer?,
                               cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
-    let friendId = String(cString: cfriendId!)
+    let (handle, friendId) = carrier.friendTable.intern(cfriendId!)
     let presence = CarrierPresenceStatus(rawValue: Int(cpresence))!
 
-    handler.friendPresenceDidChange?(carrier, friendId, presence)
+    let oldPresence = carrier.friendStore.presence(of: friendId)
+    carrier.friendStore.updatePresence(friendId, presence)
+
+    if carrier.coalesce(friendId, handle, oldPresence: oldPresence, presence: presence) {
+        return
+    }
+
+    carrier.notifyDelegate(.FriendPresence(handle, friendId, presence))
 }
 
 private func onFriendRequest(_: OpaquePointer?,
@@ -157,14 +190,13 @@ private func onFriendRequest(_: OpaquePointer?,
                              cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
     let userId = String(cString: cuserId!)
     let cUserInfo = cinfo!.assumingMemoryBound(to: CUserInfo.self).pointee
-    let info   = convertCUserInfoToCarrierUserInfo(cUserInfo)
+    let view   = CarrierUserInfoView(cUserInfo)
     let hello  = String(cString: chello!)
 
-    handler.didReceiveFriendRequest?(carrier, userId, info, hello)
+    carrier.notifyDelegate(.FriendRequest(userId, view, hello))
 }
 
 private func onFriendAdded(_: OpaquePointer?,
@@ -172,12 +204,12 @@ private func onFriendAdded(_: OpaquePointer?,
                            cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
     let cFriendInfo = cinfo!.assumingMemoryBound(to: CFriendInfo.self).pointee
-    let info = convertCFriendInfoToCarrierFriendInfo(cFriendInfo)
+    let view = CarrierFriendInfoView(cFriendInfo)
+    carrier.friendStore.update(view)
 
-    handler.newFriendAdded?(carrier, info)
+    carrier.notifyDelegate(.FriendAdded(view))
 }
 
 private func onFriendRemoved(_: OpaquePointer?,
@@ -185,35 +217,107 @@ private func onFriendRemoved(_: OpaquePointer?,
                              cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
-    let friendId = String(cString: cfriendId!)
-    handler.friendRemoved?(carrier, friendId)
+    let friendId = carrier.friendTable.intern(cfriendId!).id
+    carrier.friendStore.remove(friendId)
+
+    carrier.notifyDelegate(.FriendRemoved(friendId))
 }
 
 private func onFriendMessage(_: OpaquePointer?, cfrom: UnsafePointer<Int8>?,
-                             cmessage: UnsafePointer<Int8>?, _: Int,
+                             cmessage: UnsafePointer<Int8>?, clen: Int,
                              cctxt: UnsafeMutableRawPointer?) {
 
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
-    let from = String(cString: cfrom!)
-    let msg  = String(cString: cmessage!)
+    let (handle, from) = carrier.friendTable.intern(cfrom!)
+    let bytes = UnsafeRawBufferPointer(start: cmessage, count: clen)
+    carrier.trafficCounters.didReceive(handle, clen)
+
+    switch FrameHeader.type(of: bytes) {
+    case nil:
+        deliverFriendMessage(carrier, handle, from, bytes)
+
+    case FrameHeader.TYPE_FRAGMENT?:
+        guard let header = FrameHeader(bytes) else {
+            return
+        }
+        carrier.didReceiveFrame(from)
+
+        let payload = UnsafeRawBufferPointer(start: bytes.baseAddress! + FrameHeader.LENGTH,
+                                             count: clen - FrameHeader.LENGTH)
+
+        guard let message = carrier.reassembler.add(handle, header, payload) else {
+            return
+        }
+
+        if let rawHandler = carrier.rawMessageHandler {
+            message.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+                rawHandler(carrier, handle, UnsafeRawBufferPointer(start: ptr, count: message.count))
+            }
+        } else {
+            deliverFriendMessage(carrier, handle, from, message)
+        }
+
+    case FrameHeader.TYPE_BATCH?:
+        guard let records = MessageBatch.unpack(bytes) else {
+            return
+        }
+        carrier.didReceiveFrame(from)
+
+        for record in records {
+            deliverFriendMessage(carrier, handle, from, record)
+        }
+
+    case FrameHeader.TYPE_PING?:
+        if let pong = LatencyProber.pong(bytes) {
+            carrier.didReceiveFrame(from)
+            _ = try? carrier.sendFrame(toHandle: handle, pong)
+        }
+
+    case FrameHeader.TYPE_PONG?:
+        carrier.didReceivePong(from, bytes)
+
+    case FrameHeader.TYPE_FILE_RANGES?:
+        carrier.didReceiveFileRangeAnnounce(from, bytes)
+
+    case FrameHeader.TYPE_FILE_RANGE_IDS?:
+        carrier.didReceiveFileRangeList(from, bytes)
+
+    default:
+        // Frames of unknown types come from newer nodes, drop them.
+        break
+    }
+}
+
+private func deliverFriendMessage(_ carrier: Carrier, _ handle: Int,
+                                  _ from: String, _ bytes: UnsafeRawBufferPointer) {
+    if let rawHandler = carrier.rawMessageHandler {
+        rawHandler(carrier, handle, bytes)
+    } else if bytes.count > 0 {
+        deliverFriendMessage(carrier, handle, from, Data(bytes))
+    }
+}
 
-    handler.didReceiveFriendMessage?(carrier, from, msg)
+private func deliverFriendMessage(_ carrier: Carrier, _ handle: Int,
+                                  _ from: String, _ data: Data) {
+    carrier.notifyDelegate(.FriendMessage(handle, from, data))
 }
 
 private func onFriendInvite(_: OpaquePointer?, cfrom: UnsafePointer<Int8>?,
                             cdata: UnsafePointer<Int8>?, _: Int,
                             cctxt: UnsafeMutableRawPointer?) {
     let carrier = getCarrier(cctxt!)
-    let handler = carrier.delegate!
 
-    let from = String(cString: cfrom!)
+    let (handle, from) = carrier.friendTable.intern(cfrom!)
     let data = String(cString: cdata!)
+    carrier.trafficCounters.didReceiveInvite(handle)
 
-    handler.didReceiveFriendInviteRequest?(carrier, from, data)
+    if carrier.rpc.handleInvite(from, data) {
+        return
+    }
+
+    carrier.notifyDelegate(.FriendInvite(from, data))
 }
 
 
@@ -224,13 +328,12 @@ private func onReceiveFileQueried(_: OpaquePointer?,
                                   context: UnsafeMutableRawPointer?){
     
     let carrier = getCarrier(context!)
-    let handler = carrier.delegate!
     
     let file_name = String(cString: filename!)
     let friend_id = String(cString: friendid!)
     let message = String(cString: cmessage!)
     
-    handler.didReceiveFileQueried(carrier: carrier, friend_id, file_name, message: message)
+    carrier.notifyDelegate(.FileQueried(friend_id, file_name, message))
 }
 
 
@@ -242,13 +345,22 @@ private func onReceiveFileRequest(_: OpaquePointer?,
                                   context: UnsafeMutableRawPointer?){
     
     let carrier = getCarrier(context!)
-    let handler = carrier.delegate!
     
     let file_name = String(cString: filename!)
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
+
+    let request = FileRangeRequest(fileId: file_id, friendId: friend_id,
+                                   filename: file_name, filesize: filesize)
+    let (handled, ready) = carrier.fileRanges.didReceiveRequest(request)
+    if handled {
+        if let transfer = ready {
+            carrier.deliverMultiRangeFileRequest(transfer)
+        }
+        return
+    }
     
-    handler.didReceiveFileRequest(carrier: carrier, fileid: file_id, friend_id, file_name, filesize: filesize)
+    carrier.notifyDelegate(.FileRequest(request))
 }
 
 private func onReceiveFileAccepted(_: OpaquePointer?,
@@ -259,13 +371,12 @@ private func onReceiveFileAccepted(_: OpaquePointer?,
                                   _ context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
     let full_path = String(cString: fullpath!)
     
-    handler.didReceiveFileAccepted(carrier: ca, fileid: file_id, friendId: friend_id, fullpath: full_path, size_t: filesize)
+    ca.notifyDelegate(.FileAccepted(file_id, friend_id, full_path, filesize))
 }
 
 private func onReceiveFileRejected(_: OpaquePointer?,
@@ -274,12 +385,17 @@ private func onReceiveFileRejected(_: OpaquePointer?,
                                    _ context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
+
+    let failure = ca.fileRanges.didFail(file_id)
+    if failure.handled {
+        ca.didFailFileRange(failure.failed)
+        return
+    }
     
-    handler.didReceiveFileRejected(carrier: ca, file_id, friendid: friend_id)
+    ca.notifyDelegate(.FileRejected(file_id, friend_id))
 }
 
 private func onReceiveFilePaused(_: OpaquePointer?,
@@ -288,12 +404,11 @@ private func onReceiveFilePaused(_: OpaquePointer?,
                                  _ context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
     
-    handler.didReceiveFilePaused(carrier: ca, file_id, friendid: friend_id)
+    ca.notifyDelegate(.FilePaused(file_id, friend_id))
 }
 
 private func onReceiveFileResumed(_: OpaquePointer?,
@@ -302,12 +417,11 @@ private func onReceiveFileResumed(_: OpaquePointer?,
                                   _ context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
     
-    handler.didReceiveFileResumed(carrier: ca, file_id, friendid: friend_id)
+    ca.notifyDelegate(.FileResumed(file_id, friend_id))
 }
 
 private func onReceiveFileCanceled(_: OpaquePointer?,
@@ -316,12 +430,18 @@ private func onReceiveFileCanceled(_: OpaquePointer?,
                                    _ context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
+    ca.trafficCounters.didFinishFile(file_id)
+
+    let failure = ca.fileRanges.didFail(file_id)
+    if failure.handled {
+        ca.didFailFileRange(failure.failed)
+        return
+    }
     
-    handler.didReceiveFileCanceled(carrier: ca, file_id, friendid: friend_id)
+    ca.notifyDelegate(.FileCanceled(file_id, friend_id))
 }
 
 private func onReceiveFileCompleted(_: OpaquePointer?,
@@ -330,12 +450,20 @@ private func onReceiveFileCompleted(_: OpaquePointer?,
                                    _ context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
+    ca.trafficCounters.didFinishFile(file_id)
+
+    let completion = ca.fileRanges.didComplete(file_id)
+    if completion.handled {
+        if let transfer = completion.received {
+            ca.didReceiveFileRange(transfer, transfer.fileIds.index(of: file_id)!)
+        }
+        return
+    }
     
-    handler.didReceiveFileCompleted(carrier: ca, file_id, friendid: friend_id)
+    ca.notifyDelegate(.FileCompleted(file_id, friend_id))
 }
 
 private func onReceiveFileProgress(_: OpaquePointer?,
@@ -347,13 +475,21 @@ private func onReceiveFileProgress(_: OpaquePointer?,
                                    context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
-    let friend_id = String(cString: friendid!)
+    let (handle, friend_id) = ca.friendTable.intern(friendid!)
     let file_id = String(cString: fileid!)
     let full_path = String(cString: fullpath!)
+    ca.trafficCounters.didTransferFile(handle, file_id, transferred)
+
+    let progress = ca.fileRanges.didProgress(file_id, Int64(transferred))
+    if progress.handled {
+        if let transfer = progress.received {
+            ca.didReceiveFileRange(transfer, transfer.fileIds.index(of: file_id)!)
+        }
+        return
+    }
     
-    handler.didReceiveFileProgress(carrier: ca, file_id, friendid: friend_id, fullpath: full_path, size: Int64(size), transferred: Int64(transferred))
+    ca.notifyDelegate(.FileProgress(file_id, friend_id, full_path, size, transferred))
 }
 
 private func onReceiveFileAborted(_: OpaquePointer?,
@@ -365,13 +501,19 @@ private func onReceiveFileAborted(_: OpaquePointer?,
                                    context: UnsafeMutableRawPointer?){
     
     let ca = getCarrier(context!)
-    let handler = ca.delegate!
     
     let friend_id = String(cString: friendid!)
     let file_id = String(cString: fileid!)
     let file_name = String(cString: filename!)
+    ca.trafficCounters.didFinishFile(file_id)
+
+    let failure = ca.fileRanges.didFail(file_id)
+    if failure.handled {
+        ca.didFailFileRange(failure.failed)
+        return
+    }
     
-    handler.didReceiveFileAborted(carrier: ca, file_id, friendid: friend_id, filename: file_name, length: length, filesize: filesize)
+    ca.notifyDelegate(.FileAborted(file_id, friend_id, file_name, length, filesize))
 }
 
 internal func getNativeHandlers() -> CCallbacks {
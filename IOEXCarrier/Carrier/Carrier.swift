@@ -57,23 +57,80 @@ public class Carrier: NSObject {
         (_ carrier: Carrier, _ from: String, _ status: Int, _ reason: String?,
          _ data: String?) ->Void
 
+    public typealias CarrierCommandCompletionHandler =
+        (_ carrier: Carrier, _ error: Error?) -> Void
+
+    public typealias CarrierShutdownHandler =
+        (_ carrier: Carrier, _ report: CarrierShutdownReport?) -> Void
+
+    public typealias CarrierRawMessageHandler =
+        (_ carrier: Carrier, _ fromHandle: Int, _ bytes: UnsafeRawBufferPointer) -> Void
+
+    public typealias CarrierMulticastCompletionHandler =
+        (_ carrier: Carrier, _ result: CarrierMulticastResult) -> Void
+
+    public typealias CarrierFileProgressHandler =
+        (_ carrier: Carrier, _ transferId: Int, _ transferred: Int64, _ size: Int64) -> Void
+
+    public typealias CarrierFileCompletionHandler =
+        (_ carrier: Carrier, _ transferId: Int, _ fullpath: String?, _ error: Error?) -> Void
+
     /// Carrier node App message max length.
-    public static let MAX_APP_MESSAGE_LEN: Int = 2048
+    public static let MAX_APP_MESSAGE_LEN: Int = 1024
 
     private static let TAG: String = "Carrier"
     private static let MAX_ADDRESS_LEN: Int = 52;
     private static let MAX_ID_LEN: Int = 45
 
     private static var carrierInst: Carrier?
+    private static var carrierInsts = [OpaquePointer: Carrier]()
 
     internal var ccarrier: OpaquePointer?
+    internal private(set) var cnode: OpaquePointer?
     private  var didKill : Bool
+    private  var didStart: Bool = false
     private  let semaph  : DispatchSemaphore
 
     internal var delegate: CarrierDelegate?
 
     internal var friends: [CarrierFriendInfo]
 
+    private var eventRing: RingBuffer<CarrierEvent>?
+    private var eventCoalescer: EventCoalescer?
+    private var messageBatcher: MessageBatcher?
+    private var outboundQueue: OutboundQueue?
+    private var outboundRetries: Set<String>
+    internal private(set) var rpc: CarrierRpc!
+    internal private(set) var latencyProber: LatencyProber?
+    internal let trafficCounters: TrafficCounters
+    internal let fileRanges: FileRangeAssembler
+    private var udpEnabled: Bool = true
+    private var persistentLocation: String?
+
+    private  var loopMinInterval: Int = 0
+    private  var loopMaxInterval: Int = 0
+    private  var loopTick: Int = 0
+    private  var loopActivity: Bool = false
+    private  var loopStopping: Bool = false
+    private  let loopWakeup: DispatchSemaphore
+    private  let commandQueue: CommandQueue
+    private  let timerWheel: TimerWheel
+    private  var loopThread: Thread?
+    private let drainScheduled: UnsafeMutablePointer<Int32>
+    internal let friendTable: FriendTable
+    internal let friendStore: FriendStore
+    internal let reassembler: MessageReassembler
+    private let messageSequence: UnsafeMutablePointer<Int32>
+    private var bootstrapCache: BootstrapNodeCache?
+    private let startupMarks: UnsafeMutablePointer<UInt64>
+    private var warmStart: Bool = false
+
+    private static let BOOTSTRAP_TIMEOUT: TimeInterval = 60
+    private static let NATIVE_ITERATION_DEADLINE: Int = 50
+    private static let OUTBOUND_SAVE_INTERVAL: TimeInterval = 1
+    private static let OUTBOUND_RETRY_INTERVAL: TimeInterval = 5
+    private static let MULTICAST_SLICE: Int = 256
+
     /// Get current carrier node version.
     ///
     /// - Returns: The current carrier node version.
@@ -112,6 +169,9 @@ public class Carrier: NSObject {
     /// with first time, it's ready to start and therefore connect to the
     /// carrier network.
     ///
+    /// The singleton instance is the default node of current process. Use
+    /// `createInstance(options:delegate:)` to host more carrier nodes.
+    ///
     /// - Parameters:
     ///   - options: The options to set for carrier node
     ///   - delegate: The delegate for carrier node to comply with
@@ -121,30 +181,13 @@ public class Carrier: NSObject {
     /// - Throws: CarrierError
     public static func getInstance(options: CarrierOptions,
                                    delegate: CarrierDelegate) throws -> Carrier {
-        if (carrierInst == nil) {
-            Log.i(TAG, "Attempt to create native carrier instance ...")
-            var copts = convertCarrierOptionsToCOptions(options);
-            Log.d(TAG, "options %s",copts.bootstraps!)
-            defer {
-                cleanupCOptions(copts)
-            }
-
-            let carrier = Carrier(delegate)
-            var chandler = getNativeHandlers()
-            let cctxt = Unmanaged.passUnretained(carrier).toOpaque()
-            let ccarrier = IOEX_new(&copts, &chandler, cctxt)
-
-            guard ccarrier != nil else {
-                let errno = getErrorCode()
-                Log.d(TAG, "Create native carrier instance error: 0x%X", errno)
-                throw CarrierError.InternalError(errno: errno)
-            }
-
-            carrier.ccarrier = ccarrier
-            carrier.didKill = false
+        objc_sync_enter(Carrier.self)
+        defer {
+            objc_sync_exit(Carrier.self)
+        }
 
-            Log.d(TAG, "Native carrier node instance created.")
-            carrierInst = carrier
+        if (carrierInst == nil) {
+            carrierInst = try createInstance(options: options, delegate: delegate)
         }
         return carrierInst!
     }
@@ -153,255 +196,911 @@ public class Carrier: NSObject {
     ///
     /// - Returns: The carrier node instance or ni
     public static func getInstance() -> Carrier? {
+        objc_sync_enter(Carrier.self)
+        defer {
+            objc_sync_exit(Carrier.self)
+        }
+
         return carrierInst
     }
 
+    /// Create a new carrier node instance independent of any other nodes
+    /// in current process.
+    ///
+    /// Each node has its own identity, persistent data and event loop, so
+    /// the options of different nodes must use different persistent
+    /// locations. The node is ready to start after being created.
+    ///
+    /// - Parameters:
+    ///   - options: The options to set for carrier node
+    ///   - delegate: The delegate for carrier node to comply with
+    ///
+    /// - Returns: The new carrier node instance
+    ///
+    /// - Throws: CarrierError
+    public static func createInstance(options: CarrierOptions,
+                                      delegate: CarrierDelegate) throws -> Carrier {
+        Log.i(TAG, "Attempt to create native carrier instance ...")
+        let creating = DispatchTime.now().uptimeNanoseconds
+
+        var cache: BootstrapNodeCache? = nil
+        var nodes: [BootstrapNode]? = nil
+
+        if options.bootstrapCacheEnabled,
+            let location = options.persistentLocation {
+            cache = BootstrapNodeCache(location)
+            nodes = cache!.bootstrapNodes(with: options.bootstrapNodes ?? [])
+        }
+
+        var copts = convertCarrierOptionsToCOptions(options, nodes);
+        Log.d(TAG, "options %s",copts.bootstraps!)
+        defer {
+            cleanupCOptions(copts)
+        }
+
+        let carrier = Carrier(delegate)
+        carrier.startupMarks[StartupMark.Creating.rawValue] = creating
+        if let location = options.persistentLocation,
+            let contents = try? FileManager.default.contentsOfDirectory(atPath: location) {
+            carrier.warmStart = !contents.isEmpty
+        }
+
+        var chandler = getNativeHandlers()
+        let cctxt = Unmanaged.passUnretained(carrier).toOpaque()
+        let ccarrier = IOEX_new(&copts, &chandler, cctxt)
+
+        guard ccarrier != nil else {
+            let errno = getErrorCode()
+            Log.d(TAG, "Create native carrier instance error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        carrier.markStartup(.Created)
+        carrier.ccarrier = ccarrier
+        carrier.cnode = ccarrier
+        carrier.didKill = false
+        carrier.bootstrapCache = cache
+        carrier.persistentLocation = options.persistentLocation
+        carrier.udpEnabled = options.udpEnabled
+
+        objc_sync_enter(Carrier.self)
+        carrierInsts[ccarrier!] = carrier
+        objc_sync_exit(Carrier.self)
+
+        Log.d(TAG, "Native carrier node instance created.")
+        return carrier
+    }
+
+    /// Get all carrier node instances alive in current process.
+    ///
+    /// - Returns: The list of carrier node instances
+    public static func getInstances() -> [Carrier] {
+        objc_sync_enter(Carrier.self)
+        defer {
+            objc_sync_exit(Carrier.self)
+        }
+
+        return Array(carrierInsts.values)
+    }
+
+    private static func removeInstance(_ carrier: Carrier) {
+        objc_sync_enter(Carrier.self)
+        if carrier.cnode != nil {
+            carrierInsts.removeValue(forKey: carrier.cnode!)
+        }
+        if carrierInst === carrier {
+            carrierInst = nil
+        }
+        objc_sync_exit(Carrier.self)
+    }
+
     private init(_ delegate: CarrierDelegate) {
         self.delegate = delegate
         self.didKill = true
         self.semaph = DispatchSemaphore(value: 0)
+        self.loopWakeup = DispatchSemaphore(value: 0)
+        self.commandQueue = CommandQueue()
+        self.timerWheel = TimerWheel(resolution: 10)
         self.friends = [CarrierFriendInfo]()
+        self.outboundRetries = Set<String>()
+        self.friendTable = FriendTable()
+        self.friendStore = FriendStore()
+        self.trafficCounters = TrafficCounters(self.friendTable)
+        self.fileRanges = FileRangeAssembler()
+        self.reassembler = MessageReassembler(limit: 4 * 1024 * 1024)
+        self.messageSequence = UnsafeMutablePointer<Int32>.allocate(capacity: 1)
+        self.messageSequence.initialize(to: 0)
+        self.drainScheduled = UnsafeMutablePointer<Int32>.allocate(capacity: 1)
+        self.drainScheduled.initialize(to: 0)
+        self.startupMarks = UnsafeMutablePointer<UInt64>.allocate(capacity: StartupMark.count)
+        self.startupMarks.initialize(to: 0, count: StartupMark.count)
         super.init()
+        self.rpc = CarrierRpc(self)
     }
 
     deinit {
         kill()
+        drainScheduled.deallocate(capacity: 1)
+        startupMarks.deallocate(capacity: StartupMark.count)
+        messageSequence.deallocate(capacity: 1)
     }
 
+    /// The dispatch queue on which delegate methods and response handlers
+    /// are invoked.
+    ///
+    /// If nil, the delegate is invoked synchronously on the thread running
+    /// the native event loop, and slow delegate code delays the node. Setting
+    /// a queue lets the native loop hand off events without waiting on
+    /// application code. A serial queue keeps events in order.
+    ///
+    /// The queue applies to session and stream delegates too, except for
+    /// the stream delegate methods whose result the native node waits for:
+    /// `shouldOpenNewChannel` and `didReceiveChannelData` are invoked on
+    /// the loop thread, as is `willBecomeIdle`.
+    ///
+    /// The queue should be set before starting carrier node.
+    public var delegateQueue: DispatchQueue?
+
     /// Start carrier node asynchronously to connect to carrier network.
     /// If the connection to network is successful, carrier node starts
     /// working.
     ///
-    /// - Parameter iterateInterval: Internal loop interval, in milliseconds
+    /// - Parameters:
+    ///   - iterateInterval: Internal loop interval, in milliseconds
+    ///   - executor: The executor to run the native event loop on, or nil
+    ///               to run it on a new background dispatch queue
     ///
     /// - Throws: CarrierError
-    public func start(iterateInterval: Int = 0) throws {
+    public func start(iterateInterval: Int = 0,
+                      executor: CarrierExecutor? = nil) throws {
         guard iterateInterval >= 0 else {
             throw CarrierError.InvalidArgument
         }
 
-        let backgroundQueue = DispatchQueue(label: "org.elastos.queue",
-                                            qos: .background, target: nil)
-        weak var weakSelf = self
+        let label = String(format: "org.elastos.queue.%lx",
+                           Int(bitPattern: cnode))
+        let loopExecutor = executor ??
+            CarrierExecutor.dispatchQueue(label: label, qos: .background)
+
+        didStart = true
+        markStartup(.Starting)
+
+        if let cache = bootstrapCache {
+            try schedule(after: Carrier.BOOTSTRAP_TIMEOUT) { _ in
+                cache.recordFailure()
+            }
+        }
+
+        // The loop holds the node strongly until IOEX_run returns, since
+        // native callbacks reach it through an unretained context pointer,
+        // even after a forced kill has stopped waiting for the loop.
+        loopExecutor.execute {
+            self.loopThread = Thread.current
 
-        backgroundQueue.async {
             Log.i(Carrier.TAG, "Native carrier node started.")
-            _ = IOEX_run(weakSelf?.ccarrier, Int32(iterateInterval))
+            _ = IOEX_run(self.ccarrier, Int32(iterateInterval))
             Log.i(Carrier.TAG, "Native carrier node stopped.")
 
+            self.loopStopping = true
+            self.commandQueue.close()
+            self.messageBatcher?.cancelAll(
+                CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE)))
+            self.outboundQueue?.flush()
+
             DispatchQueue.global(qos: .background).async {
-                weakSelf?.semaph.signal()
+                self.semaph.signal()
             }
         }
     }
 
-    /// Disconnect carrier node from the server, and destroy all associated
-    /// resources to carrier node instance.
+    /// Start carrier node asynchronously with an adaptive event loop.
     ///
-    /// After calling the method, the carrier node instance becomes invalid,
-    /// and can not be refered any more.
-    public func kill() {
-        objc_sync_enter(self)
-
-        if (!didKill) {
-            Log.d(Carrier.TAG, "Actively to kill native carrier node ...");
-
-            IOEX_kill(ccarrier)
-            ccarrier = nil
-            semaph.wait()
-            Carrier.carrierInst = nil
-            delegate = nil
-            didKill = true
-            Log.i(Carrier.TAG, "Native carrier node killed and exited")
+    /// The native loop iterates every `minInterval` milliseconds while
+    /// the node is busy. Each idle iteration doubles the loop interval up
+    /// to `maxInterval`, so idle nodes use less CPU. A call to `wakeup()`
+    /// or a native event seen at the next iteration brings the loop back
+    /// to `minInterval`.
+    ///
+    /// The native node can only receive network events while it iterates,
+    /// so the idle interval is capped at 50 milliseconds, the longest
+    /// interval the native node runs its network at. A larger
+    /// `maxInterval` behaves as 50 milliseconds.
+    ///
+    /// - Parameters:
+    ///   - minInterval: The loop interval when busy, in milliseconds
+    ///   - maxInterval: The longest loop interval when idle, in milliseconds
+    ///   - executor: The executor to run the native event loop on, or nil
+    ///               to run it on a new background dispatch queue
+    ///
+    /// - Throws: CarrierError
+    public func start(minInterval: Int, maxInterval: Int,
+                      executor: CarrierExecutor? = nil) throws {
+        guard minInterval > 0 && maxInterval >= minInterval else {
+            throw CarrierError.InvalidArgument
         }
 
-        objc_sync_exit(self)
+        loopMinInterval = minInterval
+        loopMaxInterval = maxInterval
+        loopTick = minInterval
+
+        try start(iterateInterval: minInterval, executor: executor)
     }
 
-    /// Get node address associated with carrier node instance.
+    /// Wake up the event loop of carrier node to run immediately.
     ///
-    /// Returns: The node address
-    public func getAddress() -> String {
-            let len = Carrier.MAX_ADDRESS_LEN + 1
-            var data = Data(count: len);
-        
-            let address = data.withUnsafeMutableBytes() {
-                (ptr: UnsafeMutablePointer<Int8>) -> String in
-                return String(cString: IOEX_get_address(ccarrier, ptr, len))
-            }
-        
-            Log.d(Carrier.TAG, "Current carrier address: \(address)")
-            return address;
+    /// Only has effect on carrier node started with adaptive event loop,
+    /// and can be called from any thread.
+    public func wakeup() {
+        if loopMaxInterval > 0 {
+            loopWakeup.signal()
         }
-    
-    /// Get node identifier associated with the carrier node instance.
-    ///
-    /// - Returns: The node identifier
-    public func getNodeId() -> String {
-        let len  = Carrier.MAX_ID_LEN + 1
-        var data = Data(count: len)
+    }
 
-        let nodeId = data.withUnsafeMutableBytes() {
-            (ptr: UnsafeMutablePointer<Int8>) -> String in
-            return String(cString: IOEX_get_nodeid(ccarrier, ptr, len))
+    internal func loopWillSleep() {
+        guard loopMaxInterval > 0 && !loopStopping else {
+            return
         }
 
-        Log.d(Carrier.TAG, "Current carrier NodeId: \(nodeId)")
-        return nodeId
+        if loopActivity {
+            loopActivity = false
+            loopTick = loopMinInterval
+        } else {
+            loopTick = min(loopTick * 2, loopMaxInterval)
+        }
+
+        // The native node cannot iterate while the idle callback sleeps,
+        // so never hold an iteration past its network deadline.
+        var sleep = min(loopTick, Carrier.NATIVE_ITERATION_DEADLINE) - loopMinInterval
+        if let due = timerWheel.millisecondsToNextExpiration() {
+            sleep = min(sleep, Int(due))
+        }
+
+        guard sleep > 0 else {
+            return
+        }
+
+        if loopWakeup.wait(timeout: .now() + .milliseconds(sleep)) == .success {
+            while loopWakeup.wait(timeout: .now()) == .success {}
+            loopTick = loopMinInterval
+        }
     }
 
-    /// Get user identifier associated with the carrier node instance.
+    /// Submit a command to run on the event loop thread of carrier node.
     ///
-    /// - Returns: The user identifier
-    public func getUserId() -> String {
-        let len  = Carrier.MAX_ID_LEN + 1
-        var data = Data(count: len)
+    /// Submitting is lock-free and can be called from any thread. The
+    /// pending commands run in submission order at the next loop iteration,
+    /// so calls into the native node are serialized on the loop thread
+    /// without contending on locks. If carrier node has not been started
+    /// or is stopping, the command does not run, and the completion is
+    /// invoked with `IOEXERR_WRONG_STATE`.
+    ///
+    /// - Parameters:
+    ///   - command: The command to run on the loop thread
+    ///   - completion: The handler invoked asynchronously on `delegateQueue`
+    ///                 or a global queue after the command ran
+    public func submit(_ command: @escaping (Carrier) throws -> Void,
+                       completion: CarrierCommandCompletionHandler? = nil) {
+        let pushed = pushCommand {
+            var error: Error? = nil
+
+            if self.ccarrier == nil || self.loopStopping {
+                let errno = IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE)
+                error = CarrierError.InternalError(errno: errno)
+            } else {
+                do {
+                    try command(self)
+                } catch let err {
+                    error = err
+                }
+            }
 
-        let userId = data.withUnsafeMutableBytes() {
-            (ptr: UnsafeMutablePointer<Int8>) -> String in
-                return String(cString: IOEX_get_userid(ccarrier, ptr, len))
+            self.complete(completion, error)
         }
 
-        Log.d(Carrier.TAG, "Current carrier UserId: \(userId)")
-        return userId
+        if !pushed {
+            let errno = IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE)
+            complete(completion, CarrierError.InternalError(errno: errno))
+        }
     }
 
-    /// Update the nospam for carrier node address
-    ///
-    /// Update the 4-byte nospam part of the Carrier address with host byte order
-    /// expected. Nospam for Carrier address is used to eliminate spam friend
-    /// request.
+    /// Push a command for the loop thread, if the loop has been started
+    /// and is not stopping.
     ///
-    /// - Parameter newNospam: The new nospam to address.
+    /// - Returns: Whether the command will run
+    private func pushCommand(_ command: @escaping () -> Void) -> Bool {
+        guard didStart && !loopStopping && commandQueue.push(command) else {
+            return false
+        }
+
+        wakeup()
+        return true
+    }
+
+    internal func complete(_ completion: CarrierCommandCompletionHandler?,
+                           _ error: Error?) {
+        if let handler = completion {
+            let queue = delegateQueue ?? DispatchQueue.global()
+            queue.async {
+                handler(self, error)
+            }
+        }
+    }
+
+    /// Get the startup trace of carrier node, with the time each startup
+    /// phase was reached.
     ///
-    /// - Throws: CarrierError
-    public func setSelfNospam(_ newNospam: UInt32) throws {
-        let result = IOEX_set_self_nospam(ccarrier, newNospam)
+    /// - Returns: The startup trace of carrier node
+    public func getStartupTrace() -> CarrierStartupTrace {
+        return CarrierStartupTrace(startupMarks, warmStart)
+    }
 
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Set self nospam error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+    internal func markStartup(_ mark: StartupMark) {
+        if startupMarks[mark.rawValue] == 0 {
+            startupMarks[mark.rawValue] = DispatchTime.now().uptimeNanoseconds
         }
+    }
 
-        Log.i(Carrier.TAG, "Current nospam updated.")
+    internal func bootstrapDidConnect() {
+        bootstrapCache?.recordConnected()
     }
 
-    /// Get the nospam for Carrier address.
+    internal func drainCommands() {
+        if commandQueue.drain() > 0 {
+            loopActivity = true
+        }
+    }
+
+    /// Schedule a handler to run on the event loop thread of carrier node.
     ///
-    /// Get the 4-byte nospam part of the Carrier address with host byte order
-    /// expected. Nospam for Carrier address is used to eliminate spam friend
-    /// request.
+    /// Timers are kept in a hierarchical timing wheel with 10 milliseconds
+    /// resolution, so scheduling and cancelling cost O(1) and pending
+    /// timers cost nothing until they expire. The actual resolution is
+    /// bounded by the loop interval. The wheel holds delays of up to
+    /// about 46 hours, and longer delays are rejected.
     ///
-    /// - Returns: The current nospam.
+    /// - Parameters:
+    ///   - interval: The delay before the handler runs, in seconds
+    ///   - repeats: Whether to run the handler every `interval` until the
+    ///              timer is cancelled
+    ///   - handler: The handler to run on the loop thread
     ///
-    /// - Throws: CarrierError
-    public func getSelfNospam() throws -> UInt32 {
-        var nospam: UInt32 = 0
-        let result = IOEX_get_self_nospam(ccarrier, &nospam)
+    /// - Returns: The scheduled timer
+    ///
+    /// - Throws: CarrierError, with `IOEXERR_WRONG_STATE` if the event
+    ///           loop has exited
+    @discardableResult
+    public func schedule(after interval: TimeInterval, repeat repeats: Bool = false,
+                         _ handler: @escaping CarrierTimerHandler) throws -> CarrierTimer {
+        guard isSchedulable(interval) else {
+            throw CarrierError.InvalidArgument
+        }
 
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Get self nospam error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+        let timer = CarrierTimer(self, UInt64(interval * 1000), repeats, handler)
+
+        if Thread.current == loopThread {
+            timerWheel.add(timer)
+        } else {
+            // Timers pushed while the loop is stopping would never fire.
+            let pushed = !loopStopping && commandQueue.push {
+                if !timer.isCancelled {
+                    self.timerWheel.add(timer)
+                }
+            }
+
+            guard pushed else {
+                throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+            }
+            wakeup()
         }
 
-        Log.i(Carrier.TAG, "Current node spam: \(nospam)")
-        return nospam
+        return timer
     }
 
-    /// Update self user information.
-    ///
-    /// After self user information changed, carrier node will update this
-    /// information to network, and thereupon network broadcasts the change to
-    //  all friends.
+    /// Whether the timer wheel can hold a delay, in seconds.
+    internal func isSchedulable(_ interval: TimeInterval) -> Bool {
+        return interval >= 0 && interval * 1000 <= Double(timerWheel.maxMilliseconds)
+    }
 
-    /// - Parameter newUserInfo: The new user information to set
-    ///
-    /// - Throws: CarrierError
-    public func setSelfUserInfo(_ newUserInfo: CarrierUserInfo) throws {
-        var cinfo = convertCarrierUserInfoToCUserInfo(newUserInfo)
-        let result = IOEX_set_self_info(ccarrier, &cinfo)
+    internal func unscheduleTimer(_ timer: CarrierTimer) {
+        if Thread.current == loopThread {
+            timerWheel.remove(timer)
+        } else {
+            let pushed = commandQueue.push {
+                self.timerWheel.remove(timer)
+            }
 
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Update self user infos error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+            // The queue closes after the loop is done with the wheel.
+            if !pushed {
+                timerWheel.remove(timer)
+            }
         }
+    }
 
-        Log.i(Carrier.TAG, "Current user information updated.")
+    internal func runTimers() {
+        timerWheel.advance()
     }
 
-    /// Get self user information.
+    /// Enable batched delivery of delegate events.
     ///
-    /// - Returns: The current user information
+    /// Native callbacks push the converted events into a preallocated
+    /// lock-free ring instead of invoking the delegate, and the events are
+    /// delivered in batches on `delegateQueue`. If no delegate queue is
+    /// set, application must call `drainEvents(maxCount:)` from one thread
+    /// to deliver them. When the ring is full new events are dropped and
+    /// counted in `getEventRingStats()`.
+    ///
+    /// The event ring should be enabled before starting carrier node.
+    ///
+    /// - Parameter capacity: The number of event slots, rounded up to the
+    ///                       next power of two
     ///
     /// - Throws: CarrierError
-    @objc(getSelfUserInfo:)
-    public func getSelfUserInfo() throws -> CarrierUserInfo {
-        var cinfo = CUserInfo()
-        let result = IOEX_get_self_info(ccarrier, &cinfo)
-
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Get current user infos error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+    public func enableEventRing(capacity: Int = 1024) throws {
+        guard capacity > 0 else {
+            throw CarrierError.InvalidArgument
         }
 
-        let info = convertCUserInfoToCarrierUserInfo(cinfo)
-        Log.d(Carrier.TAG, "Current user infos: \(info)")
-        return info
+        eventRing = RingBuffer<CarrierEvent>(capacity: capacity)
     }
 
-    /// Set self presence status
+    /// Get the statistics of the event ring.
     ///
-    /// - Parameter newPresence: The new presence status to friends.
-    ///
-    /// - Throws: CarrierError
-    public func setSelfPresence(_ newPresence: CarrierPresenceStatus) throws {
-        let presence = convertCarrierPresenceStatusToCPresenceStatus(newPresence)
-        let result = IOEX_set_self_presence(ccarrier, presence)
-
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Set self presence error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+    /// - Returns: The event ring statistics, or nil if the event ring is
+    ///            not enabled
+    public func getEventRingStats() -> CarrierEventRingStats? {
+        guard let ring = eventRing else {
+            return nil
         }
 
-        Log.d(Carrier.TAG, "Self presence updated to be: \(newPresence)")
+        return CarrierEventRingStats(capacity: ring.capacity,
+                                     depth: ring.count,
+                                     highWatermark: Int(ring.highWatermark),
+                                     droppedEvents: Int(ring.dropped))
     }
 
-    /// Get self presence status
+    /// Enable coalescing of friend connection status and presence events.
     ///
-    /// - Returns: The current presence status
+    /// Events of each friend are merged over the window, and only the net
+    /// final state is delivered at the end of the window. Friends flapping
+    /// back to their original state are not reported. All net changes of
+    /// a window are delivered together to `friendStatesDidChange`, or, if
+    /// the delegate does not implement it, once per friend to the
+    /// connection and presence delegate methods.
+    ///
+    /// Event coalescing should be enabled before starting carrier node.
+    ///
+    /// - Parameter window: The coalescing window, in seconds
     ///
     /// - Throws: CarrierError
-    //@objc(getSelfPresence:)
-    public func getSelfPresence() throws -> CarrierPresenceStatus {
-        var cpresence = CPresenceStatus_None
-        let result = IOEX_get_self_presence(ccarrier, &cpresence)
-
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Get self presence error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+    public func enableEventCoalescing(window: TimeInterval) throws {
+        guard window > 0 else {
+            throw CarrierError.InvalidArgument
         }
 
-        let presence = convertCPresenceStatusToCarrierPresenceStatus(cpresence.rawValue)
-        Log.d(Carrier.TAG, "Current self presence: \(presence)")
-        return presence
+        eventCoalescer = EventCoalescer(window: window)
     }
 
-    /// Check if carrier node instance is being ready.
+    /// Get the number of friend events merged away by event coalescing.
     ///
-    /// - Returns: true if the carrier node instance is ready, or false if not
-    public func isReady() -> Bool {
-        return IOEX_is_ready(ccarrier)
+    /// - Returns: The number of coalesced events
+    public func getCoalescedEventCount() -> Int {
+        return Int(eventCoalescer?.coalesced ?? 0)
     }
 
-    /// Get current user's friend list
-    ///
-    /// - Returns: The list of friend information
+    internal func coalesce(_ friendId: String, _ handle: Int,
+                           oldStatus: CarrierConnectionStatus?,
+                           status: CarrierConnectionStatus) -> Bool {
+        guard let coalescer = eventCoalescer else {
+            return false
+        }
+
+        let wasEmpty = coalescer.isEmpty
+        coalescer.add(friendId, handle, oldStatus: oldStatus, status: status)
+        if wasEmpty {
+            scheduleCoalescedFlush(coalescer)
+        }
+        return true
+    }
+
+    internal func coalesce(_ friendId: String, _ handle: Int,
+                           oldPresence: CarrierPresenceStatus?,
+                           presence: CarrierPresenceStatus) -> Bool {
+        guard let coalescer = eventCoalescer else {
+            return false
+        }
+
+        let wasEmpty = coalescer.isEmpty
+        coalescer.add(friendId, handle, oldPresence: oldPresence, presence: presence)
+        if wasEmpty {
+            scheduleCoalescedFlush(coalescer)
+        }
+        return true
+    }
+
+    private func scheduleCoalescedFlush(_ coalescer: EventCoalescer) {
+        weak var weakSelf = self
+
+        _ = try? schedule(after: coalescer.window) { _ in
+            weakSelf?.flushCoalescedEvents(coalescer)
+        }
+    }
+
+    private func flushCoalescedEvents(_ coalescer: EventCoalescer) {
+        let store = friendStore
+        let changes = coalescer.flush(status: { store.status(of: $0) },
+                                      presence: { store.presence(of: $0) })
+        guard !changes.isEmpty else {
+            return
+        }
+
+        notifyDelegate(.FriendStates(changes))
+    }
+
+    /// Deliver pending events in the event ring to the delegate on calling
+    /// thread.
+    ///
+    /// Only used when the event ring is enabled without `delegateQueue`,
+    /// and must always be called from the same thread.
+    ///
+    /// - Parameter maxCount: The maximum number of events to deliver
+    ///
+    /// - Returns: The number of events delivered
+    @discardableResult
+    public func drainEvents(maxCount: Int = Int.max) -> Int {
+        guard let ring = eventRing, delegateQueue == nil else {
+            return 0
+        }
+
+        return deliverEvents(ring, maxCount)
+    }
+
+    private func deliverEvents(_ ring: RingBuffer<CarrierEvent>,
+                               _ maxCount: Int) -> Int {
+        var delivered = 0
+
+        while delivered < maxCount, let event = ring.pop() {
+            if let handler = delegate {
+                event.deliver(self, handler)
+            }
+            delivered += 1
+        }
+
+        return delivered
+    }
+
+    private func scheduleEventDrain(_ ring: RingBuffer<CarrierEvent>,
+                                    _ queue: DispatchQueue) {
+        guard OSAtomicCompareAndSwap32Barrier(0, 1, drainScheduled) else {
+            return
+        }
+
+        queue.async {
+            _ = self.deliverEvents(ring, ring.capacity)
+            OSAtomicCompareAndSwap32Barrier(1, 0, self.drainScheduled)
+
+            if ring.count > 0 {
+                self.scheduleEventDrain(ring, queue)
+            }
+        }
+    }
+
+    internal func notifyDelegate(_ event: CarrierEvent) {
+        loopActivity = true
+
+        if let ring = eventRing {
+            _ = ring.push(event)
+            if let queue = delegateQueue {
+                scheduleEventDrain(ring, queue)
+            }
+            return
+        }
+
+        guard let queue = delegateQueue else {
+            if let handler = delegate {
+                event.deliver(self, handler)
+            }
+            return
+        }
+
+        queue.async {
+            if let handler = self.delegate {
+                event.deliver(self, handler)
+            }
+        }
+    }
+
+    internal func dispatchToDelegateQueue(_ work: @escaping () -> Void) {
+        guard let queue = delegateQueue else {
+            work()
+            return
+        }
+
+        queue.async(execute: work)
+    }
+
+    /// Disconnect carrier node from the server, and destroy all associated
+    /// resources to carrier node instance.
+    ///
+    /// After calling the method, the carrier node instance becomes invalid,
+    /// and can not be refered any more.
+    public func kill() {
+        _ = shutdown(timeout: nil)
+    }
+
+    /// Disconnect carrier node from the server asynchronously, and destroy
+    /// all associated resources to carrier node instance.
+    ///
+    /// If the native event loop has not exited when the deadline runs out,
+    /// the node stops waiting for it, and the report is marked as forced.
+    /// The loop keeps the node alive until it really exits.
+    ///
+    /// After calling the method, the carrier node instance becomes invalid,
+    /// and can not be refered any more.
+    ///
+    /// - Parameters:
+    ///   - deadline: The longest time to wait for shutdown, in seconds
+    ///   - completion: The handler to receive the shutdown report, invoked
+    ///                 on `delegateQueue` or a global queue. The report is
+    ///                 nil if carrier node had already been killed
+    public func kill(deadline: TimeInterval,
+                     completion: CarrierShutdownHandler? = nil) {
+        let queue = delegateQueue ?? DispatchQueue.global()
+
+        DispatchQueue.global().async {
+            let report = self.shutdown(timeout: max(0, deadline))
+
+            if let handler = completion {
+                queue.async {
+                    handler(self, report)
+                }
+            }
+        }
+    }
+
+    private func shutdown(timeout: TimeInterval?) -> CarrierShutdownReport? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard !didKill else {
+            return nil
+        }
+
+        Log.d(Carrier.TAG, "Actively to kill native carrier node ...");
+
+        let begin = DispatchTime.now()
+
+        CarrierSessionManager.getInstance(of: self)?.cleanup()
+        let sessionsClosed = DispatchTime.now()
+
+        loopStopping = true
+        wakeup()
+        IOEX_kill(ccarrier)
+        ccarrier = nil
+        let nodeKilled = DispatchTime.now()
+
+        var forced = false
+        if didStart {
+            if let timeout = timeout {
+                let elapsed = Carrier.seconds(from: begin, to: nodeKilled)
+                let remaining = max(0, timeout - elapsed)
+                forced = semaph.wait(timeout: .now() + remaining) == .timedOut
+            } else {
+                semaph.wait()
+            }
+        }
+        let loopStopped = DispatchTime.now()
+
+        Carrier.removeInstance(self)
+        RequestTable.shared.removeAll(ownedBy: self)
+        delegate = nil
+        didKill = true
+
+        let report = CarrierShutdownReport(
+            closingSessions: Carrier.seconds(from: begin, to: sessionsClosed),
+            leavingNetwork: Carrier.seconds(from: sessionsClosed, to: nodeKilled),
+            flushingPersistentData: Carrier.seconds(from: nodeKilled, to: loopStopped),
+            forced: forced)
+
+        if forced {
+            Log.w(Carrier.TAG, "Native carrier node killed without waiting " +
+                "event loop exited: \(report)")
+        } else {
+            Log.i(Carrier.TAG, "Native carrier node killed and exited: \(report)")
+        }
+
+        return report
+    }
+
+    private static func seconds(from start: DispatchTime, to end: DispatchTime) -> TimeInterval {
+        return TimeInterval(end.uptimeNanoseconds - start.uptimeNanoseconds) / 1e9
+    }
+
+    /// Get node address associated with carrier node instance.
+    ///
+    /// Returns: The node address
+    public func getAddress() -> String {
+            let len = Carrier.MAX_ADDRESS_LEN + 1
+            var data = Data(count: len);
+        
+            let address = data.withUnsafeMutableBytes() {
+                (ptr: UnsafeMutablePointer<Int8>) -> String in
+                return String(cString: IOEX_get_address(ccarrier, ptr, len))
+            }
+        
+            Log.d(Carrier.TAG, "Current carrier address: \(address)")
+            return address;
+        }
+    
+    /// Get node identifier associated with the carrier node instance.
+    ///
+    /// - Returns: The node identifier
+    public func getNodeId() -> String {
+        let len  = Carrier.MAX_ID_LEN + 1
+        var data = Data(count: len)
+
+        let nodeId = data.withUnsafeMutableBytes() {
+            (ptr: UnsafeMutablePointer<Int8>) -> String in
+            return String(cString: IOEX_get_nodeid(ccarrier, ptr, len))
+        }
+
+        Log.d(Carrier.TAG, "Current carrier NodeId: \(nodeId)")
+        return nodeId
+    }
+
+    /// Get user identifier associated with the carrier node instance.
+    ///
+    /// - Returns: The user identifier
+    public func getUserId() -> String {
+        let len  = Carrier.MAX_ID_LEN + 1
+        var data = Data(count: len)
+
+        let userId = data.withUnsafeMutableBytes() {
+            (ptr: UnsafeMutablePointer<Int8>) -> String in
+                return String(cString: IOEX_get_userid(ccarrier, ptr, len))
+        }
+
+        Log.d(Carrier.TAG, "Current carrier UserId: \(userId)")
+        return userId
+    }
+
+    /// Update the nospam for carrier node address
+    ///
+    /// Update the 4-byte nospam part of the Carrier address with host byte order
+    /// expected. Nospam for Carrier address is used to eliminate spam friend
+    /// request.
+    ///
+    /// - Parameter newNospam: The new nospam to address.
+    ///
+    /// - Throws: CarrierError
+    public func setSelfNospam(_ newNospam: UInt32) throws {
+        let result = IOEX_set_self_nospam(ccarrier, newNospam)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Set self nospam error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        Log.i(Carrier.TAG, "Current nospam updated.")
+    }
+
+    /// Get the nospam for Carrier address.
+    ///
+    /// Get the 4-byte nospam part of the Carrier address with host byte order
+    /// expected. Nospam for Carrier address is used to eliminate spam friend
+    /// request.
+    ///
+    /// - Returns: The current nospam.
+    ///
+    /// - Throws: CarrierError
+    public func getSelfNospam() throws -> UInt32 {
+        var nospam: UInt32 = 0
+        let result = IOEX_get_self_nospam(ccarrier, &nospam)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Get self nospam error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        Log.i(Carrier.TAG, "Current node spam: \(nospam)")
+        return nospam
+    }
+
+    /// Update self user information.
+    ///
+    /// After self user information changed, carrier node will update this
+    /// information to network, and thereupon network broadcasts the change to
+    //  all friends.
+
+    /// - Parameter newUserInfo: The new user information to set
+    ///
+    /// - Throws: CarrierError
+    public func setSelfUserInfo(_ newUserInfo: CarrierUserInfo) throws {
+        var cinfo = convertCarrierUserInfoToCUserInfo(newUserInfo)
+        let result = IOEX_set_self_info(ccarrier, &cinfo)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Update self user infos error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        Log.i(Carrier.TAG, "Current user information updated.")
+    }
+
+    /// Get self user information.
+    ///
+    /// - Returns: The current user information
+    ///
+    /// - Throws: CarrierError
+    @objc(getSelfUserInfo:)
+    public func getSelfUserInfo() throws -> CarrierUserInfo {
+        var cinfo = CUserInfo()
+        let result = IOEX_get_self_info(ccarrier, &cinfo)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Get current user infos error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        let info = convertCUserInfoToCarrierUserInfo(cinfo)
+        Log.d(Carrier.TAG, "Current user infos: \(info)")
+        return info
+    }
+
+    /// Set self presence status
+    ///
+    /// - Parameter newPresence: The new presence status to friends.
+    ///
+    /// - Throws: CarrierError
+    public func setSelfPresence(_ newPresence: CarrierPresenceStatus) throws {
+        let presence = convertCarrierPresenceStatusToCPresenceStatus(newPresence)
+        let result = IOEX_set_self_presence(ccarrier, presence)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Set self presence error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        Log.d(Carrier.TAG, "Self presence updated to be: \(newPresence)")
+    }
+
+    /// Get self presence status
+    ///
+    /// - Returns: The current presence status
+    ///
+    /// - Throws: CarrierError
+    //@objc(getSelfPresence:)
+    public func getSelfPresence() throws -> CarrierPresenceStatus {
+        var cpresence = CPresenceStatus_None
+        let result = IOEX_get_self_presence(ccarrier, &cpresence)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Get self presence error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        let presence = convertCPresenceStatusToCarrierPresenceStatus(cpresence.rawValue)
+        Log.d(Carrier.TAG, "Current self presence: \(presence)")
+        return presence
+    }
+
+    /// Check if carrier node instance is being ready.
+    ///
+    /// - Returns: true if the carrier node instance is ready, or false if not
+    public func isReady() -> Bool {
+        return IOEX_is_ready(ccarrier)
+    }
+
+    /// Get current user's friend list
+    ///
+    /// - Returns: The list of friend information
     //
     /// - Throws: CarrierError
     @objc(getFriends:)
@@ -425,191 +1124,940 @@ public class Carrier: NSObject {
 
         guard result >= 0 else {
             let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Get current user's friends error: 0x%X", errno)
+            Log.e(Carrier.TAG, "Get current user's friends error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        for friend in friends {
+            friendStore.update(friend)
+        }
+        friendStore.markLoaded()
+
+        Log.d(Carrier.TAG, "Current user has \(friends.count) friends.")
+        return friends
+    }
+
+    /// Get a page of current user's friend list.
+    ///
+    /// The native friend list is walked only up to the end of the page,
+    /// and only friends inside the page are converted.
+    ///
+    /// - Parameters:
+    ///   - offset: The index of the first friend in the page
+    ///   - limit: The maximum number of friends in the page
+    ///
+    /// - Returns: The list of friend information in the page
+    ///
+    /// - Throws: CarrierError
+    @objc(getFriendsFromOffset:limit:error:)
+    public func getFriends(offset: Int, limit: Int) throws -> [CarrierFriendInfo] {
+        guard offset >= 0 && limit > 0 else {
+            throw CarrierError.InvalidArgument
+        }
+
+        final class PageContext {
+            let offset: Int
+            let end: Int
+            var index: Int = 0
+            var friends = [CarrierFriendInfo]()
+
+            init(_ offset: Int, _ limit: Int) {
+                self.offset = offset
+                self.end = offset > Int.max - limit ? Int.max : offset + limit
+            }
+        }
+
+        let cb: CFriendsIterateCallback = { (cinfo, ctxt) in
+            guard cinfo != nil else {
+                return false
+            }
+
+            let page = Unmanaged<PageContext>.fromOpaque(ctxt!).takeUnretainedValue()
+            if page.index >= page.offset {
+                let cFriendInfo = cinfo!.assumingMemoryBound(to: CFriendInfo.self).pointee
+                page.friends.append(convertCFriendInfoToCarrierFriendInfo(cFriendInfo))
+            }
+            page.index += 1
+
+            return page.index < page.end
+        }
+
+        let page = PageContext(offset, limit)
+        let result = withExtendedLifetime(page) { () -> Int32 in
+            let cctxt = Unmanaged.passUnretained(page).toOpaque()
+            return IOEX_get_friends(ccarrier, cb, cctxt)
+        }
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Get current user's friends error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        return page.friends
+    }
+
+    /// Get current user's friends connected to carrier network.
+    ///
+    /// The friends are looked up from an index kept up to date by friend
+    /// events, in time proportional to the number of online friends.
+    ///
+    /// - Returns: The list of online friend information
+    @objc(getOnlineFriends)
+    public func getOnlineFriends() -> [CarrierFriendInfo] {
+        return friendStore.friends(withStatus: .Connected)
+    }
+
+    /// Get current user's friends with the given presence status.
+    ///
+    /// The friends are looked up from an index kept up to date by friend
+    /// events, in time proportional to the number of matched friends.
+    ///
+    /// - Parameter presence: The presence status to match
+    ///
+    /// - Returns: The list of matched friend information
+    @objc(getFriendsWithPresence:)
+    public func getFriends(withPresence presence: CarrierPresenceStatus) -> [CarrierFriendInfo] {
+        return friendStore.friends(withPresence: presence)
+    }
+
+    /// Get the friends changed since the given revision of the friend list.
+    ///
+    /// The friend list is kept up to date by friend events, so the query
+    /// does not call into native node. Pass 0 to get all friends, then pass
+    /// the returned revision to get further changes only.
+    ///
+    /// - Parameter revision: The revision returned by the last query, or 0
+    ///
+    /// - Returns: The friends changed and removed since the revision
+    @objc(getFriendChangesSinceRevision:)
+    public func getFriendChanges(since revision: UInt64) -> CarrierFriendChanges {
+        return friendStore.changes(since: revision)
+    }
+
+    /// Get specified friend information.
+    ///
+    /// - Parameter friendId: The user identifier of friend
+    ///
+    /// - Returns: The friend information to user `friendId`
+    ///
+    /// - Throws: CarrierError
+    @objc(getFriendInfoForFriend:error:)
+    public func getFriendInfo(_ friendId: String) throws ->CarrierFriendInfo {
+        if friendStore.isLoaded, let info = friendStore.get(friendId) {
+            return info
+        }
+
+        var cinfo = CFriendInfo()
+        let result = friendId.withCString { (cfriendId) -> Int32 in
+            return IOEX_get_friend_info(ccarrier, cfriendId, &cinfo)
+        }
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Get infos of friend \(friendId) error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        let info = convertCFriendInfoToCarrierFriendInfo(cinfo)
+        Log.d(Carrier.TAG, "The infos of friend \(friendId): \(info)")
+        return info
+    }
+
+    /// Get the handle of the specified friend.
+    ///
+    /// A handle is a stable integer standing for the friend id during the
+    /// life of carrier node. Calls and delegate methods taking handles
+    /// avoid converting friend ids on every message.
+    ///
+    /// - Parameter friendId: The user identifier of friend
+    ///
+    /// - Returns: The handle of friend
+    ///
+    /// - Throws: CarrierError
+    @objc(getHandleForFriend:error:)
+    public func getFriendHandle(_ friendId: String) throws -> Int {
+        guard Carrier.isValidId(friendId) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        return friendTable.intern(friendId)
+    }
+
+    /// Get the user identifier of friend by its handle.
+    ///
+    /// - Parameter handle: The handle of friend
+    ///
+    /// - Returns: The user identifier of friend, or nil if the handle is
+    ///            unknown
+    @objc(getFriendIdForHandle:)
+    public func getFriendId(ofHandle handle: Int) -> String? {
+        return friendTable.id(of: handle)
+    }
+
+    /// Get specified friend information by handle.
+    ///
+    /// - Parameter handle: The handle of friend
+    ///
+    /// - Returns: The friend information
+    ///
+    /// - Throws: CarrierError
+    @objc(getFriendInfoForHandle:error:)
+    public func getFriendInfo(ofHandle handle: Int) throws -> CarrierFriendInfo {
+        guard let cfriendId = friendTable.cid(of: handle) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        var cinfo = CFriendInfo()
+        let result = IOEX_get_friend_info(ccarrier, cfriendId, &cinfo)
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Get infos of friend handle \(handle) error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        return convertCFriendInfoToCarrierFriendInfo(cinfo)
+    }
+
+    /// Set the label of the specified friend.
+    ///
+    /// The label of a friend is a private alias name for current user. 
+    /// It can be seen by current user only, and has no impact to the target 
+    /// friend itself.
+    ///
+    /// - Parameters:
+    ///   - friendId: the friend's user identifier
+    ///   - newLabel: the new label of specified friend
+    ///
+    /// - Throws: CarrierError
+    @objc(setLabelForFriend:withLabel:error:)
+    public func setFriendLabel(forFriend friendId: String, newLabel: String) throws {
+
+        let result = friendId.withCString { (cfriendId) in
+            return newLabel.withCString { (clabel) in
+                return IOEX_set_friend_label(ccarrier, cfriendId, clabel);
+            }
+        }
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Set friend \(friendId)'s label error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        friendStore.updateLabel(friendId, newLabel)
+        Log.d(Carrier.TAG, "Friend \(friendId)'s label changed -> \(newLabel)")
+    }
+
+    /// Check if the user ID is friend.
+    ///
+    /// - Parameter userId: The userId to check
+    ///
+    /// - Returns: True if the user is friend, otherwise false
+    @objc(isFriendWithUser:)
+    public func isFriend(with userId: String) -> Bool {
+        if friendStore.isLoaded {
+            return friendStore.contains(userId)
+        }
+
+        return userId.withCString { (ptr) -> Bool in
+            return Bool(IOEX_is_friend(ccarrier, ptr))
+        }
+    }
+
+    /// Attempt to add friend by sending a new friend request.
+    ///
+    /// This function will add a new friend with specific address, and then
+    /// send a friend request to the target node.
+    ///
+    /// - Parameters:
+    ///   - userId: The target user id
+    ///   - hello: PIN for target user, or any application defined
+    ///            content.
+    ///
+    /// - Throws: CarrierError
+    public func addFriend(with userId: String,
+                          withGreeting hello: String) throws {
+
+        Log.d(Carrier.TAG, "Begin to add be friend with user \(userId)" +
+            "by sending friend request with hello: \(hello) to \(userId)")
+
+        let result = userId.withCString { (cuserId) in
+            return hello.withCString { (chello) in
+                return IOEX_add_friend(ccarrier, cuserId, chello)
+            }
+        }
+        wakeup()
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Send friend request to user \(userId)" +
+                " error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        Log.d(Carrier.TAG, "Sended a friend request to user \(userId).")
+    }
+
+    /// Attempt to add friend by sending a new friend request from the event
+    /// loop thread.
+    ///
+    /// - Parameters:
+    ///   - userId: The target user id
+    ///   - hello: PIN for target user, or any application defined
+    ///            content.
+    ///   - completion: The handler invoked after the request was sent
+    public func addFriend(with userId: String, withGreeting hello: String,
+                          completion: @escaping CarrierCommandCompletionHandler) {
+        submit({ (carrier) in
+            try carrier.addFriend(with: userId, withGreeting: hello)
+        }, completion: completion)
+    }
+
+    /// Accept the friend request.
+    ///
+    /// This function is used to add a friend in response to a friend request.
+    ///
+    /// - Parameters:
+    ///   - userId: The user id who want be friend with current user
+    ///
+    /// - Throws: CarrierError
+    public func acceptFriend(with userId: String) throws {
+
+        let result = userId.withCString { (cuserId) -> Int32 in
+            return IOEX_accept_friend(ccarrier, cuserId)
+        }
+        wakeup()
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Accept user \(userId) as be friend " +
+                "error: 0x%X", errno)
             throw CarrierError.InternalError(errno: errno)
         }
 
-        Log.d(Carrier.TAG, "Current user's friends listed below: +++>>")
-        for friend in friends {
-            Log.d(Carrier.TAG, "\(friend)");
-        }
-        Log.d(Carrier.TAG, "<<+++")
-
-        return friends
+        Log.d(Carrier.TAG, "Accepted user \(userId) as friend.")
     }
 
-    /// Get specified friend information.
+    /// Remove friendship with the specified friend.
     ///
-    /// - Parameter friendId: The user identifier of friend
+    /// If all correct, Carrier network will clean the friend relationship,
+    /// and send friend removed message to both.
     ///
-    /// - Returns: The friend information to user `friendId`
+    /// - Parameter friendId: The target user id to remove friendship.
     ///
     /// - Throws: CarrierError
-    @objc(getFriendInfoForFriend:error:)
-    public func getFriendInfo(_ friendId: String) throws ->CarrierFriendInfo {
-        var cinfo = CFriendInfo()
+    public func removeFriend(_ friendId: String) throws {
         let result = friendId.withCString { (cfriendId) -> Int32 in
-            return IOEX_get_friend_info(ccarrier, cfriendId, &cinfo)
+            return IOEX_remove_friend(ccarrier, cfriendId)
         }
 
         guard result >= 0 else {
             let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Get infos of friend \(friendId) error: 0x%X", errno)
+            Log.e(Carrier.TAG, "Remove friend \(friendId) error: 0x%X", errno)
             throw CarrierError.InternalError(errno: errno)
         }
 
-        let info = convertCFriendInfoToCarrierFriendInfo(cinfo)
-        Log.d(Carrier.TAG, "The infos of friend \(friendId): \(info)")
-        return info
+        Log.d(Carrier.TAG, "Friend \(friendId) was removed")
     }
 
-    /// Set the label of the specified friend.
+    /// Send a message to the specified friend.
     ///
-    /// The label of a friend is a private alias name for current user. 
-    /// It can be seen by current user only, and has no impact to the target 
-    /// friend itself.
+    /// The message length may not exceed `MAX_APP_MESSAGE_LEN`, and message
+    /// itself should be text-formatted. Larger messages can be sent with
+    /// `sendLargeFriendMessage(to:withData:)`.
     ///
     /// - Parameters:
-    ///   - friendId: the friend's user identifier
-    ///   - newLabel: the new label of specified friend
+    ///   - target: The target id
+    ///   - msg: The message content defined by application
     ///
     /// - Throws: CarrierError
-    @objc(setLabelForFriend:withLabel:error:)
-    public func setFriendLabel(forFriend friendId: String, newLabel: String) throws {
-
-        let result = friendId.withCString { (cfriendId) in
-            return newLabel.withCString { (clabel) in
-                return IOEX_set_friend_label(ccarrier, cfriendId, clabel);
+    public func sendFriendMessage(to target: String, withMessage msg: String) throws {
+        let len: Int = msg.utf8CString.count
+        let result = target.withCString {(cto) in
+            return msg.withCString { (cmsg) -> Int32 in
+                return IOEX_send_friend_message(ccarrier, cto, cmsg, len)
             }
         }
+        wakeup()
 
         guard result >= 0 else {
             let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Set friend \(friendId)'s label error: 0x%X", errno)
+            trafficCounters.didFailToSend(friendTable.handle(of: target), errno)
+            Log.e(Carrier.TAG, "Send message to \(target) error: 0x%X", errno)
             throw CarrierError.InternalError(errno: errno)
         }
 
-        Log.d(Carrier.TAG, "Friend \(friendId)'s label changed -> \(newLabel)")
+        trafficCounters.didSend(friendTable.intern(target), len)
+        Log.d(Carrier.TAG, "Sended message: \(msg) to \(target).")
     }
 
-    /// Check if the user ID is friend.
+    /// Send a message to the specified friend by handle.
     ///
-    /// - Parameter userId: The userId to check
+    /// - Parameters:
+    ///   - handle: The handle of target friend
+    ///   - msg: The message content defined by application
     ///
-    /// - Returns: True if the user is friend, otherwise false
-    @objc(isFriendWithUser:)
-    public func isFriend(with userId: String) -> Bool {
-        return userId.withCString { (ptr) -> Bool in
-            return Bool(IOEX_is_friend(ccarrier, ptr))
+    /// - Throws: CarrierError
+    @objc(sendFriendMessageToHandle:withMessage:error:)
+    public func sendFriendMessage(toHandle handle: Int, withMessage msg: String) throws {
+        guard let cto = friendTable.cid(of: handle) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        let len: Int = msg.utf8CString.count
+        let result = msg.withCString { (cmsg) -> Int32 in
+            return IOEX_send_friend_message(ccarrier, cto, cmsg, len)
+        }
+        wakeup()
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            trafficCounters.didFailToSend(handle, errno)
+            Log.e(Carrier.TAG, "Send message to friend handle \(handle) error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
         }
+
+        trafficCounters.didSend(handle, len)
     }
 
-    /// Attempt to add friend by sending a new friend request.
+    /// Send a binary message to the specified friend.
     ///
-    /// This function will add a new friend with specific address, and then
-    /// send a friend request to the target node.
+    /// The bytes are passed to native node as they are, without string
+    /// conversion or NUL terminator. The length may not exceed
+    /// `MAX_APP_MESSAGE_LEN`. Messages starting with byte 0xFA are sent
+    /// in a frame, which is removed again by the receiving node.
     ///
     /// - Parameters:
-    ///   - userId: The target user id
-    ///   - hello: PIN for target user, or any application defined
-    ///            content.
+    ///   - target: The target id
+    ///   - data: The message content defined by application
     ///
     /// - Throws: CarrierError
-    public func addFriend(with userId: String,
-                          withGreeting hello: String) throws {
+    @objc(sendFriendMessageTo:withData:error:)
+    public func sendFriendMessage(to target: String, withData data: Data) throws {
+        try data.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+            try sendFriendMessage(to: target,
+                                  bytes: UnsafeRawBufferPointer(start: ptr, count: data.count))
+        }
+    }
 
-        Log.d(Carrier.TAG, "Begin to add be friend with user \(userId)" +
-            "by sending friend request with hello: \(hello) to \(userId)")
+    /// Send a binary message from a raw buffer to the specified friend.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - bytes: The message content defined by application
+    ///
+    /// - Throws: CarrierError
+    public func sendFriendMessage(to target: String, bytes: UnsafeRawBufferPointer) throws {
+        guard let base = bytes.baseAddress, bytes.count > 0 else {
+            throw CarrierError.InvalidArgument
+        }
 
-        let result = userId.withCString { (cuserId) in
-            return hello.withCString { (chello) in
-                return IOEX_add_friend(ccarrier, cuserId, chello)
+        // Messages starting with the frame magic would be taken for frames
+        // by the receiving node, so they are sent in a frame themselves.
+        guard bytes[0] != FrameHeader.MAGIC else {
+            guard bytes.count <= Carrier.MAX_APP_MESSAGE_LEN else {
+                throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_TOO_LONG))
             }
+            try sendLargeFriendMessage(to: target, withData: Data(bytes: base, count: bytes.count))
+            return
+        }
+
+        try sendFrame(to: target, bytes)
+    }
+
+    /// Send a binary message to the specified friend by handle.
+    ///
+    /// - Parameters:
+    ///   - handle: The handle of target friend
+    ///   - data: The message content defined by application
+    ///
+    /// - Throws: CarrierError
+    @objc(sendFriendMessageToHandle:withData:error:)
+    public func sendFriendMessage(toHandle handle: Int, withData data: Data) throws {
+        guard !data.isEmpty else {
+            throw CarrierError.InvalidArgument
+        }
+
+        guard FrameHeader.needsFraming(data) else {
+            try sendFrame(toHandle: handle, data)
+            return
+        }
+
+        guard data.count <= Carrier.MAX_APP_MESSAGE_LEN else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_TOO_LONG))
+        }
+
+        let messageId = UInt32(bitPattern: OSAtomicIncrement32Barrier(messageSequence))
+        for fragment in FrameHeader.fragments(of: data, messageId: messageId)! {
+            try sendFrame(toHandle: handle, fragment)
         }
+    }
+
+    /// Send a message to native node as it is, without framing.
+    ///
+    /// Only used for frames, and for messages known not to start with the
+    /// frame magic.
+    internal func sendFrame(to target: String, _ frame: UnsafeRawBufferPointer) throws {
+        let result = target.withCString { (cto) -> Int32 in
+            return IOEX_send_friend_message(ccarrier, cto, frame.baseAddress, frame.count)
+        }
+        wakeup()
 
         guard result >= 0 else {
             let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Send friend request to user \(userId)" +
-                " error: 0x%X", errno)
+            trafficCounters.didFailToSend(friendTable.handle(of: target), errno)
+            Log.e(Carrier.TAG, "Send message to \(target) error: 0x%X", errno)
             throw CarrierError.InternalError(errno: errno)
         }
 
-        Log.d(Carrier.TAG, "Sended a friend request to user \(userId).")
+        trafficCounters.didSend(friendTable.intern(target), frame.count)
+    }
+
+    internal func sendFrame(to target: String, _ frame: Data) throws {
+        try frame.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+            try sendFrame(to: target, UnsafeRawBufferPointer(start: ptr, count: frame.count))
+        }
+    }
+
+    internal func sendFrame(toHandle handle: Int, _ frame: Data) throws {
+        guard let cto = friendTable.cid(of: handle) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        let result = frame.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> Int32 in
+            return IOEX_send_friend_message(ccarrier, cto, ptr, frame.count)
+        }
+        wakeup()
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            trafficCounters.didFailToSend(handle, errno)
+            Log.e(Carrier.TAG, "Send message to friend handle \(handle) error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        trafficCounters.didSend(handle, frame.count)
+    }
+
+    /// The handler to receive friend messages as raw bytes, without any
+    /// copy.
+    ///
+    /// The handler is invoked synchronously on the event loop thread, and
+    /// the bytes are only valid during the call. When the handler is set,
+    /// the message methods of the delegate are not invoked.
+    ///
+    /// The handler should be set before starting carrier node.
+    public var rawMessageHandler: CarrierRawMessageHandler?
+
+    /// The maximum bytes of partially received large messages kept per
+    /// friend. Large messages longer than the limit are dropped, and when
+    /// a new message would exceed it, the oldest partial messages of the
+    /// friend are dropped. Defaults to 4 MiB.
+    ///
+    /// The limit should be set before starting carrier node.
+    public var largeMessageLimit: Int {
+        set {
+            reassembler.limit = newValue
+        }
+        get {
+            return reassembler.limit
+        }
+    }
+
+    /// Send a message of any length to the specified friend.
+    ///
+    /// The message is split into fragments of at most `MAX_APP_MESSAGE_LEN`,
+    /// which are sent back to back without waiting for each other. The
+    /// receiving node reassembles them and delivers the whole message once
+    /// through `didReceiveFriendMessage(_:_:data:)`.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - data: The message content defined by application
+    ///
+    /// - Throws: CarrierError
+    @objc(sendLargeFriendMessageTo:withData:error:)
+    public func sendLargeFriendMessage(to target: String, withData data: Data) throws {
+        guard !data.isEmpty else {
+            throw CarrierError.InvalidArgument
+        }
+
+        let messageId = UInt32(bitPattern: OSAtomicIncrement32Barrier(messageSequence))
+        guard let fragments = FrameHeader.fragments(of: data, messageId: messageId) else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_TOO_LONG))
+        }
+
+        for fragment in fragments {
+            try sendFrame(to: target, fragment)
+        }
+
+        Log.d(Carrier.TAG, "Sended message of \(data.count) bytes in " +
+            "\(fragments.count) fragments to \(target).")
+    }
+
+    /// Send a message of any length to the specified friend from the
+    /// event loop thread.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - data: The message content defined by application
+    ///   - completion: The handler invoked after all fragments were sent
+    public func sendLargeFriendMessage(to target: String, withData data: Data,
+                                       completion: @escaping CarrierCommandCompletionHandler) {
+        submit({ (carrier) in
+            try carrier.sendLargeFriendMessage(to: target, withData: data)
+        }, completion: completion)
+    }
+
+    /// Send one message to many friends from the event loop thread.
+    ///
+    /// The message is validated and framed once for all friends. Sends run
+    /// on the loop thread in slices of recipients, so other commands and
+    /// native events are not starved by large lists. Targets that are not
+    /// valid ids fail with an invalid argument error without being sent.
+    ///
+    /// - Parameters:
+    ///   - targets: The target ids
+    ///   - data: The message content defined by application, of any length
+    ///   - completion: The handler invoked with the status of every friend
+    ///                 after all sends ran
+    public func sendFriendMessage(toFriends targets: [String], withData data: Data,
+                                  completion: @escaping CarrierMulticastCompletionHandler) {
+        var frames: [Data]? = nil
+
+        if data.count > Carrier.MAX_APP_MESSAGE_LEN || FrameHeader.needsFraming(data) {
+            let messageId = UInt32(bitPattern: OSAtomicIncrement32Barrier(messageSequence))
+            frames = FrameHeader.fragments(of: data, messageId: messageId)
+        } else if !data.isEmpty {
+            frames = [data]
+        }
+
+        guard let framed = frames else {
+            let errno = data.isEmpty ? IOEX_GENERAL_ERROR(IOEXERR_INVALID_ARGS) :
+                IOEX_GENERAL_ERROR(IOEXERR_TOO_LONG)
+            var failed = [String: Int]()
+            for target in targets {
+                failed[target] = errno
+            }
+            completeMulticast(completion, CarrierMulticastResult([], failed))
+            return
+        }
+
+        var recipients = [MulticastSend.Recipient]()
+        var invalid = [String: Int]()
+        recipients.reserveCapacity(targets.count)
+        for target in Set(targets) {
+            // Only valid ids are interned, the friend table lives forever.
+            guard Carrier.isValidId(target) else {
+                invalid[target] = IOEX_GENERAL_ERROR(IOEXERR_INVALID_ARGS)
+                continue
+            }
+
+            let handle = friendTable.intern(target)
+            if let cid = friendTable.cid(of: handle) {
+                recipients.append((handle, target, cid))
+            }
+        }
+
+        runMulticast(MulticastSend(framed, recipients, failed: invalid), completion)
+    }
+
+    /// Send one message to all friends with the specified label from the
+    /// event loop thread.
+    ///
+    /// - Parameters:
+    ///   - label: The label of target friends
+    ///   - data: The message content defined by application, of any length
+    ///   - completion: The handler invoked with the status of every friend
+    ///                 after all sends ran
+    public func sendFriendMessage(toGroup label: String, withData data: Data,
+                                  completion: @escaping CarrierMulticastCompletionHandler) {
+        if !friendStore.isLoaded {
+            _ = try? getFriends()
+        }
+
+        sendFriendMessage(toFriends: friendStore.friendIds(withLabel: label),
+                          withData: data, completion: completion)
+    }
+
+    private func runMulticast(_ multicast: MulticastSend,
+                              _ completion: @escaping CarrierMulticastCompletionHandler) {
+        let pushed = pushCommand {
+            if self.ccarrier == nil || self.loopStopping {
+                multicast.cancel(IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+            } else {
+                multicast.send(Carrier.MULTICAST_SLICE) { (recipient, frame) -> Int in
+                    let result = frame.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> Int32 in
+                        return IOEX_send_friend_message(self.ccarrier, recipient.cid,
+                                                        ptr, frame.count)
+                    }
+
+                    guard result >= 0 else {
+                        let errno = getErrorCode()
+                        self.trafficCounters.didFailToSend(recipient.handle, errno)
+                        return errno
+                    }
+
+                    self.trafficCounters.didSend(recipient.handle, frame.count)
+                    return 0
+                }
+            }
+
+            if multicast.isDone {
+                let result = multicast.result()
+                Log.d(Carrier.TAG, "Multicast message sent to \(result.sent.count) " +
+                    "friends, failed to \(result.failed.count).")
+                self.completeMulticast(completion, result)
+            } else {
+                self.runMulticast(multicast, completion)
+            }
+        }
+
+        if !pushed {
+            multicast.cancel(IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+            completeMulticast(completion, multicast.result())
+        }
+    }
+
+    private func completeMulticast(_ completion: @escaping CarrierMulticastCompletionHandler,
+                                   _ result: CarrierMulticastResult) {
+        let queue = delegateQueue ?? DispatchQueue.global()
+        queue.async {
+            completion(self, result)
+        }
+    }
+
+    /// Enable batching of small friend messages sent with
+    /// `sendBatchedFriendMessage(to:withData:completion:)`.
+    ///
+    /// Messages queued to the same friend within `maxDelay` are packed into
+    /// one friend message of at most `maxBytes`, and unpacked into separate
+    /// messages by the receiving node.
+    ///
+    /// Message batching should be enabled before starting carrier node.
+    ///
+    /// - Parameters:
+    ///   - maxDelay: The longest time a message waits for others, in seconds
+    ///   - maxBytes: The byte threshold to send a batch at once, at most
+    ///               `MAX_APP_MESSAGE_LEN`
+    ///
+    /// - Throws: CarrierError
+    public func enableMessageBatching(maxDelay: TimeInterval,
+                                      maxBytes: Int = Carrier.MAX_APP_MESSAGE_LEN) throws {
+        let minBytes = MessageBatch.HEADER_LEN + MessageBatch.RECORD_HEADER_LEN * 2 + 2
+        guard maxDelay >= 0 && maxBytes >= minBytes &&
+            maxBytes <= Carrier.MAX_APP_MESSAGE_LEN else {
+            throw CarrierError.InvalidArgument
+        }
+
+        messageBatcher = MessageBatcher(self, maxDelay: maxDelay, maxBytes: maxBytes)
+    }
+
+    /// Queue a message to the specified friend, to be sent in a batch with
+    /// other small messages to the same friend.
+    ///
+    /// Messages to the same friend are sent in order. If message batching
+    /// is not enabled, the message is sent at the next loop iteration.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - data: The message content defined by application
+    ///   - completion: The handler invoked after the batch was sent
+    public func sendBatchedFriendMessage(to target: String, withData data: Data,
+                                         completion: CarrierCommandCompletionHandler? = nil) {
+        guard !data.isEmpty else {
+            complete(completion, CarrierError.InvalidArgument)
+            return
+        }
+
+        let pushed = pushCommand {
+            if self.ccarrier == nil || self.loopStopping {
+                let errno = IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE)
+                self.complete(completion, CarrierError.InternalError(errno: errno))
+            } else if let batcher = self.messageBatcher {
+                batcher.add(target, data, completion)
+            } else {
+                self.complete(completion, self.sendMessage(to: target, data))
+            }
+        }
+
+        if !pushed {
+            let errno = IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE)
+            complete(completion, CarrierError.InternalError(errno: errno))
+        }
+    }
+
+    /// Enable the persistent outbound queues of friend messages used by
+    /// `enqueueFriendMessage(to:withData:)`.
+    ///
+    /// Each friend has a bounded queue saved under the persistent location,
+    /// so messages queued while the friend is offline survive restarts and
+    /// are sent in order once the friend connects. The delegate is told
+    /// when a queue rises to `highWatermark`, and again when it drains to
+    /// `lowWatermark`.
+    ///
+    /// The outbound queue should be enabled before starting carrier node.
+    ///
+    /// - Parameters:
+    ///   - capacity: The most messages queued to one friend
+    ///   - highWatermark: The queue depth to report backpressure at
+    ///   - lowWatermark: The queue depth to report drained at
+    ///
+    /// - Throws: CarrierError
+    public func enableOutboundQueue(capacity: Int, highWatermark: Int,
+                                    lowWatermark: Int) throws {
+        guard capacity > 0 && highWatermark > lowWatermark &&
+            highWatermark <= capacity && lowWatermark >= 0 else {
+            throw CarrierError.InvalidArgument
+        }
+
+        guard outboundQueue == nil else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_ALREADY_EXIST))
+        }
+
+        let queue = OutboundQueue(persistentLocation, capacity: capacity,
+                                  highWatermark: highWatermark,
+                                  lowWatermark: lowWatermark)
+        outboundQueue = queue
+
+        try schedule(after: Carrier.OUTBOUND_SAVE_INTERVAL, repeat: true) { _ in
+            queue.save()
+        }
+
+        // Queues restored above the high watermark report it once, as if
+        // they had just risen to it.
+        commandQueue.push {
+            for friendId in queue.friendIdsAboveHighWatermark() {
+                self.notifyDelegate(.OutboundHighWatermark(friendId, queue.highWatermark))
+            }
+            for friendId in queue.friendIds() {
+                self.flushOutbound(friendId)
+            }
+        }
+    }
+
+    /// Queue a message to the specified friend, to be sent in order as soon
+    /// as the friend is online.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - data: The message content defined by application
+    ///
+    /// - Throws: CarrierError, with `IOEXERR_LIMIT_EXCEEDED` if the queue
+    ///           of the friend is full
+    public func enqueueFriendMessage(to target: String, withData data: Data) throws {
+        guard let queue = outboundQueue else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+        }
+
+        // The id names the file the queue is saved to.
+        guard !data.isEmpty && Carrier.isValidId(target) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        let (accepted, high) = queue.push(target, data)
+        guard accepted else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_LIMIT_EXCEEDED))
+        }
+
+        commandQueue.push {
+            if high {
+                let depth = queue.highWatermark
+                self.notifyDelegate(.OutboundHighWatermark(target, depth))
+            }
+            self.flushOutbound(target)
+        }
+        wakeup()
     }
 
-    /// Accept the friend request.
-    ///
-    /// This function is used to add a friend in response to a friend request.
+    /// Get the depths of the outbound queues of all friends with messages
+    /// queued.
     ///
-    /// - Parameters:
-    ///   - userId: The user id who want be friend with current user
-    ///
-    /// - Throws: CarrierError
-    public func acceptFriend(with userId: String) throws {
+    /// - Returns: The number of queued messages, by friend id
+    public func getOutboundQueueDepths() -> [String: Int] {
+        return outboundQueue?.depths() ?? [:]
+    }
 
-        let result = userId.withCString { (cuserId) -> Int32 in
-            return IOEX_accept_friend(ccarrier, cuserId)
+    /// Send the queued messages of the friend in order, until the queue is
+    /// empty or the friend goes offline. Must run on the loop thread.
+    internal func flushOutbound(_ friendId: String) {
+        guard let queue = outboundQueue, ccarrier != nil, !loopStopping else {
+            return
         }
 
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Accept user \(userId) as be friend " +
-                "error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
-        }
+        while let data = queue.peek(friendId) {
+            if let error = sendMessage(to: friendId, data) {
+                var errno = 0
+                if case CarrierError.InternalError(let code) = error {
+                    errno = code
+                }
 
-        Log.d(Carrier.TAG, "Accepted user \(userId) as friend.")
+                // Offline friends are flushed again once they connect, and
+                // other transient errors are retried later.
+                switch errno {
+                case IOEX_GENERAL_ERROR(IOEXERR_FRIEND_OFFLINE):
+                    return
+                case IOEX_GENERAL_ERROR(IOEXERR_INVALID_ARGS),
+                     IOEX_GENERAL_ERROR(IOEXERR_TOO_LONG),
+                     IOEX_GENERAL_ERROR(IOEXERR_NOT_EXIST):
+                    Log.w(Carrier.TAG, "Drop queued message to \(friendId): \(error)")
+                default:
+                    scheduleOutboundRetry(friendId)
+                    return
+                }
+            }
+
+            if queue.pop(friendId) {
+                let depth = queue.depth(friendId)
+                notifyDelegate(.OutboundLowWatermark(friendId, depth))
+            }
+        }
     }
 
-    /// Remove friendship with the specified friend.
-    ///
-    /// If all correct, Carrier network will clean the friend relationship,
-    /// and send friend removed message to both.
-    ///
-    /// - Parameter friendId: The target user id to remove friendship.
-    ///
-    /// - Throws: CarrierError
-    public func removeFriend(_ friendId: String) throws {
-        let result = friendId.withCString { (cfriendId) -> Int32 in
-            return IOEX_remove_friend(ccarrier, cfriendId)
+    private func scheduleOutboundRetry(_ friendId: String) {
+        guard !outboundRetries.contains(friendId) else {
+            return
         }
 
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Remove friend \(friendId) error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
+        weak var weakSelf = self
+        do {
+            _ = try schedule(after: Carrier.OUTBOUND_RETRY_INTERVAL) { _ in
+                weakSelf?.outboundRetries.remove(friendId)
+                weakSelf?.flushOutbound(friendId)
+            }
+            outboundRetries.insert(friendId)
+        } catch {
+            Log.w(Carrier.TAG, "Schedule outbound retry to \(friendId) error: \(error)")
         }
+    }
 
-        Log.d(Carrier.TAG, "Friend \(friendId) was removed")
+    /// Send a message of any length and content, framing it if needed.
+    internal func sendMessage(to target: String, _ data: Data) -> Error? {
+        do {
+            if data.count > Carrier.MAX_APP_MESSAGE_LEN || FrameHeader.needsFraming(data) {
+                try sendLargeFriendMessage(to: target, withData: data)
+            } else {
+                try sendFriendMessage(to: target, withData: data)
+            }
+        } catch let error {
+            return error
+        }
+        return nil
     }
 
-    /// Send a message to the specified friend.
-    ///
-    /// The message length may not exceed `MAX_APP_MESSAGE_LEN`, and message
-    /// itself should be text-formatted. Larger messages must be splitted by
-    /// application and sent as separate messages. Other nodes can reassemble 
-    /// the fragments.
+    /// Send a message to the specified friend from the event loop thread.
     ///
     /// - Parameters:
     ///   - target: The target id
     ///   - msg: The message content defined by application
-    ///
-    /// - Throws: CarrierError
-    public func sendFriendMessage(to target: String, withMessage msg: String) throws {
-        let result = target.withCString {(cto) in
-            return msg.withCString { (cmsg) -> Int32 in
-                let len: Int = msg.utf8CString.count
-                return IOEX_send_friend_message(ccarrier, cto, cmsg, len)
-            }
-        }
-
-        guard result >= 0 else {
-            let errno: Int = getErrorCode()
-            Log.e(Carrier.TAG, "Send message to \(target) error: 0x%X", errno)
-            throw CarrierError.InternalError(errno: errno)
-        }
-
-        Log.d(Carrier.TAG, "Sended message: \(msg) to \(target).")
+    ///   - completion: The handler invoked after the message was sent
+    public func sendFriendMessage(to target: String, withMessage msg: String,
+                                  completion: @escaping CarrierCommandCompletionHandler) {
+        submit({ (carrier) in
+            try carrier.sendFriendMessage(to: target, withMessage: msg)
+        }, completion: completion)
     }
 
     /// Send invite request to the specified friend
@@ -622,20 +2070,56 @@ public class Carrier: NSObject {
     ///   - data: The application defined data send to target user
     ///   - responseHandler: The callback to receive invite reponse
     ///
+    /// - Returns: The pending request, which can be cancelled before the
+    ///            response arrives
+    ///
+    /// - Throws: CarrierError
+    @discardableResult
+    public func sendInviteFriendRequest(to target: String,
+                                        withData data: String,
+                                        responseHandler: @escaping CarrierFriendInviteResponseHandler) throws -> CarrierRequest {
+        return try sendInviteFriendRequest(to: target, withData: data, timeout: 0,
+                                           responseHandler: responseHandler)
+    }
+
+    /// Send invite request to the specified friend, expiring it if no
+    /// response arrives in time.
+    ///
+    /// Any number of invite requests can be pending to the same friend at
+    /// once, each with its own timeout. An expired request invokes the
+    /// response handler with `CarrierRequest.TIMEOUT_STATUS`, and a
+    /// response arriving after that is dropped.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - data: The application defined data send to target user
+    ///   - timeout: The time to wait for the response, in seconds, or 0 to
+    ///              wait forever. At most about 46 hours
+    ///   - responseHandler: The callback to receive invite reponse
+    ///
+    /// - Returns: The pending request, which can be cancelled before the
+    ///            response arrives
+    ///
     /// - Throws: CarrierError
+    @discardableResult
     public func sendInviteFriendRequest(to target: String,
                                         withData data: String,
-                                        responseHandler: @escaping CarrierFriendInviteResponseHandler) throws {
+                                        timeout: TimeInterval,
+                                        responseHandler: @escaping CarrierFriendInviteResponseHandler) throws -> CarrierRequest {
+        guard isSchedulable(timeout) else {
+            throw CarrierError.InvalidArgument
+        }
 
         let cb: CFriendInviteResponseCallback = {
 
            (_, cfrom, cstatus, creason, cdata, clen, cctxt) in
 
-                let ectxt = Unmanaged<AnyObject>.fromOpaque(cctxt!)
-                    .takeRetainedValue() as! [AnyObject?]
+                guard let request = RequestTable.shared.take(RequestTable.id(cctxt!)) else {
+                    return
+                }
 
-                let carrier = ectxt[0] as! Carrier
-                let handler = ectxt[1] as! CarrierFriendInviteResponseHandler
+                let carrier = request.owner as! Carrier
+                let handler = request.handler as! CarrierFriendInviteResponseHandler
 
                 let from = String(cString: cfrom!)
                 let status = Int(cstatus)
@@ -648,12 +2132,41 @@ public class Carrier: NSObject {
                     _data = String(cString: cdata!)
                 }
 
-                handler(carrier, from, status, reason, _data)
+                carrier.dispatchToDelegateQueue {
+                    handler(carrier, from, status, reason, _data)
+                }
+        }
+
+        guard let id = RequestTable.shared.add(self, responseHandler) else {
+            Log.e(Carrier.TAG, "Invite friend to \(target) error: too many pending requests")
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_LIMIT_EXCEEDED))
         }
+        let cctxt = RequestTable.context(id)
+
+        // The timer is scheduled before sending, so an invite is never
+        // sent without the timeout it was asked for.
+        if timeout > 0 {
+            let timer = try? schedule(after: timeout) { _ in
+                guard let request = RequestTable.shared.expire(id) else {
+                    return
+                }
+
+                let carrier = request.owner as! Carrier
+                let handler = request.handler as! CarrierFriendInviteResponseHandler
 
-        let econtext: [AnyObject?] = [self, responseHandler as AnyObject]
-        let unmanaged = Unmanaged.passRetained(econtext as AnyObject)
-        let cctxt = unmanaged.toOpaque()
+                Log.w(Carrier.TAG, "Invite friend to \(target) timed out.")
+                carrier.dispatchToDelegateQueue {
+                    handler(carrier, target, CarrierRequest.TIMEOUT_STATUS,
+                            CarrierRequest.TIMEOUT_REASON, nil)
+                }
+            }
+
+            guard timer != nil else {
+                RequestTable.shared.remove(id)
+                throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+            }
+            RequestTable.shared.setTimer(id, timer!)
+        }
 
         Log.d(Carrier.TAG, "Begin to invite friend to \(target) with greet data" +
             " \(data)")
@@ -664,15 +2177,144 @@ public class Carrier: NSObject {
                 return IOEX_invite_friend(ccarrier, cto, cdata, len, cb, cctxt)
             }
         }
+        wakeup()
 
+        // Removing the request cancels its timer too.
         guard result >= 0 else {
-            unmanaged.release()
+            RequestTable.shared.remove(id)
             let errno = getErrorCode()
             Log.e(Carrier.TAG, "Invite friend to \(target) error: 0x%X", errno)
             throw CarrierError.InternalError(errno: errno)
         }
 
+        trafficCounters.didSendInvite(friendTable.intern(target))
         Log.d(Carrier.TAG, "Sended friend invite request to \(target).")
+        return CarrierRequest(id)
+    }
+
+    /// Enable round-trip time probing of connected friends.
+    ///
+    /// Every `interval` a small ping frame is sent over the friend message
+    /// path to each connected friend known to handle frames, and friends
+    /// echo it back. The RTTs are kept in a fixed-size log2 histogram per
+    /// friend.
+    ///
+    /// Friends running older versions would deliver ping frames to their
+    /// application as text, so a friend is only probed once it has sent a
+    /// valid frame itself, or after `enableLatencyProbing(of:)` opted it
+    /// in. As pings are frames too, a friend that is probed starts
+    /// probing back if it has probing enabled.
+    ///
+    /// Latency probing should be enabled before starting carrier node.
+    ///
+    /// - Parameter interval: The probing interval, in seconds
+    ///
+    /// - Throws: CarrierError
+    public func enableLatencyProbing(interval: TimeInterval) throws {
+        guard interval > 0 else {
+            throw CarrierError.InvalidArgument
+        }
+
+        guard latencyProber == nil else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_ALREADY_EXIST))
+        }
+
+        let prober = LatencyProber(interval: interval)
+        latencyProber = prober
+
+        Log.i(Carrier.TAG, "Latency probing every \(interval)s over " +
+            (udpEnabled ? "UDP or TCP relay" : "TCP relay") + " transport.")
+
+        weak var weakSelf = self
+        try schedule(after: interval, repeat: true) { _ in
+            guard let carrier = weakSelf else {
+                return
+            }
+
+            let connected = carrier.friendStore.friendIds(withStatus: .Connected)
+            for friendId in prober.peers(of: connected) {
+                do {
+                    try carrier.sendFrame(to: friendId, prober.ping(friendId))
+                } catch let error {
+                    Log.w(Carrier.TAG, "Probe friend \(friendId) error: \(error)")
+                }
+            }
+        }
+    }
+
+    /// Get the round-trip times measured to all probed friends.
+    ///
+    /// - Returns: The latency statistics of probed friends
+    public func getLatencyStats() -> [CarrierLatencyStats] {
+        return latencyProber?.stats() ?? []
+    }
+
+    /// Get the round-trip times measured to the specified friend.
+    ///
+    /// - Parameter friendId: The friend's user id
+    ///
+    /// - Returns: The latency statistics, or nil if the friend was never
+    ///            probed
+    public func getLatencyStats(of friendId: String) -> CarrierLatencyStats? {
+        return latencyProber?.stats(friendId)
+    }
+
+    /// Opt the specified friend in to latency probing, when it is known
+    /// to run a version that answers ping frames.
+    ///
+    /// - Parameter friendId: The friend's user id
+    ///
+    /// - Throws: CarrierError, with `IOEXERR_WRONG_STATE` if latency
+    ///           probing is not enabled
+    @objc(enableLatencyProbingOf:error:)
+    public func enableLatencyProbing(of friendId: String) throws {
+        guard Carrier.isValidId(friendId) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        guard let prober = latencyProber else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+        }
+
+        prober.addPeer(friendId)
+    }
+
+    /// Record that the friend sent a valid frame, and so handles frames.
+    internal func didReceiveFrame(_ friendId: String) {
+        latencyProber?.addPeer(friendId)
+    }
+
+    internal func didReceivePong(_ friendId: String, _ bytes: UnsafeRawBufferPointer) {
+        guard let rtt = latencyProber?.didReceivePong(friendId, bytes) else {
+            return
+        }
+
+        let transport = udpEnabled ? "UDP or TCP relay" : "TCP relay"
+        Log.d(Carrier.TAG, "RTT to \(friendId) over \(transport): %.3f ms",
+              Double(rtt) / 1000)
+    }
+
+    /// Get a snapshot of the traffic counters of carrier node and of all
+    /// friends.
+    ///
+    /// Taking a snapshot never blocks the event loop, so it can be
+    /// scraped frequently.
+    ///
+    /// - Returns: The traffic counters snapshot
+    public func getTrafficSnapshot() -> CarrierTrafficSnapshot {
+        return trafficCounters.snapshot()
+    }
+
+    /// Get the RPC endpoint of carrier node, carried over friend invite
+    /// requests.
+    ///
+    /// Once the endpoint is created, invite requests carrying RPC calls are
+    /// handled by it instead of `didReceiveFriendInviteRequest`.
+    ///
+    /// - Returns: The RPC endpoint
+    public func getRpc() -> CarrierRpc {
+        rpc.activate()
+        return rpc
     }
 
     /// Reply the friend invite request.
@@ -738,6 +2380,7 @@ public class Carrier: NSObject {
             return IOEX_reply_friend_invite(ccarrier, cto, CInt(status),
                                            creason, cdata, len)
         }
+        wakeup()
 
         guard result >= 0 else {
             let errno: Int = getErrorCode()
@@ -753,17 +2396,281 @@ public class Carrier: NSObject {
         return IOEX_send_file_query(ccarrier, friendid, filename, messeage)
     }
     
+    /// Send a request to the specified friend to send it a file.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - friendid: The target id
+    ///   - filename: The path of the file to send
+    ///
+    /// - Returns: 0 on success, or -1 if an error occurred
+    @available(*, deprecated, message: "Use sendFileRequest(to:filename:) to get the file id")
     public func sendFileRequest(carrier: Carrier, friendid:String, filename:String) -> Int32 {
-        let len = Carrier.MAX_ADDRESS_LEN + 1
-        var data = Data(count: len);
-        
-        let fileId = data.withUnsafeMutableBytes() {
-            (ptr: UnsafeMutablePointer<Int8>) -> Int in
-            IOEX_send_file_request(ccarrier, fileid: ptr, id_len: len, friendid: friendid, filename: filename)
-            return 0;
+        do {
+            _ = try sendFileRequest(to: friendid, filename: filename)
+            return 0
+        } catch {
+            return -1
+        }
+    }
+
+    /// Send a request to the specified friend to send it a file.
+    ///
+    /// - Parameters:
+    ///   - friendid: The target id
+    ///   - filename: The path of the file to send
+    ///
+    /// - Returns: The file id of the transfer
+    ///
+    /// - Throws: CarrierError
+    public func sendFileRequest(to friendid: String, filename: String) throws -> String {
+        let len = Carrier.MAX_ID_LEN + 1
+        var data = Data(count: len)
+
+        let result = data.withUnsafeMutableBytes() {
+            (ptr: UnsafeMutablePointer<Int8>) -> Int32 in
+            return IOEX_send_file_request(ccarrier, fileid: ptr, id_len: len,
+                                          friendid: friendid, filename: filename)
+        }
+
+        guard result >= 0 else {
+            let errno: Int = getErrorCode()
+            Log.e(Carrier.TAG, "Send file request to \(friendid) error: 0x%X", errno)
+            throw CarrierError.InternalError(errno: errno)
+        }
+
+        let fileId = data.withUnsafeBytes() { (ptr: UnsafePointer<Int8>) -> String in
+            return String(cString: ptr)
+        }
+
+        Log.d(Carrier.TAG, "Sended file request \(fileId) to \(friendid).")
+        return fileId
+    }
+
+    /// Send a file to the specified friend as several range transfers
+    /// running concurrently.
+    ///
+    /// The friend is told about the file first, then one file request is
+    /// sent per range, and then the file ids of the ranges are listed. The
+    /// receiving node collects the listed requests into one transfer
+    /// reported by `didReceiveMultiRangeFileRequest`, and seeks each
+    /// transfer to the start of its own range. The receiver cancels each
+    /// range transfer once it has reached the end of its range, which is
+    /// reported here as cancelled.
+    ///
+    /// - Parameters:
+    ///   - friendid: The target id
+    ///   - filename: The path of the file to send
+    ///   - rangeCount: The number of ranges, at most 16
+    ///
+    /// - Returns: The file ids of the range transfers
+    ///
+    /// - Throws: CarrierError
+    public func sendMultiRangeFileRequest(to friendid: String, filename: String,
+                                          rangeCount: Int) throws -> [String] {
+        guard rangeCount > 0 && rangeCount <= FileRangeAssembler.MAX_RANGES &&
+            !filename.isEmpty else {
+            throw CarrierError.InvalidArgument
+        }
+
+        try sendFrame(to: friendid, FileRangeAssembler.announce(filename, rangeCount))
+
+        var fileIds = [String]()
+        do {
+            for _ in 0..<rangeCount {
+                fileIds.append(try sendFileRequest(to: friendid, filename: filename))
+            }
+            try sendFrame(to: friendid, FileRangeAssembler.list(filename, fileIds))
+        } catch let error {
+            for fileId in fileIds {
+                _ = sendFileCancel(carrier: self, fileid: fileId)
+            }
+            throw error
+        }
+
+        Log.d(Carrier.TAG, "Sended file \(filename) to \(friendid) in \(rangeCount) ranges.")
+        return fileIds
+    }
+
+    /// Accept a multi-range file from a friend.
+    ///
+    /// The destination file is preallocated at its full size. Each range
+    /// is received into a part file next to it, and copied into place as
+    /// soon as it has been received.
+    ///
+    /// - Parameters:
+    ///   - transferId: The id of the multi-range file transfer
+    ///   - filepath: The directory to store the file in
+    ///   - filename: The name to store the file as
+    ///   - progress: The handler invoked with the bytes received over all
+    ///               ranges
+    ///   - completion: The handler invoked after the file was assembled or
+    ///                 the transfer failed
+    ///
+    /// - Throws: CarrierError
+    public func acceptMultiRangeFile(transferId: Int, filepath: String, filename: String,
+                                     progress: CarrierFileProgressHandler? = nil,
+                                     completion: @escaping CarrierFileCompletionHandler) throws {
+        guard let transfer = fileRanges.transfer(transferId), !transfer.isAccepted else {
+            throw CarrierError.InvalidArgument
+        }
+
+        var progressHandler: ((Int64, Int64) -> Void)? = nil
+        if let handler = progress {
+            progressHandler = { (transferred, size) in
+                self.dispatchToDelegateQueue {
+                    handler(self, transferId, transferred, size)
+                }
+            }
+        }
+
+        try fileRanges.accept(transfer, filepath, filename, progressHandler) {
+            (fullpath, error) in
+            if error != nil {
+                self.submit({ (carrier) in
+                    carrier.cancelFileRanges(transfer)
+                    carrier.fileRanges.remove(transfer)
+                })
+            }
+
+            let queue = self.delegateQueue ?? DispatchQueue.global()
+            queue.async {
+                completion(self, transferId, fullpath, error)
+            }
+        }
+
+        for (index, fileId) in transfer.fileIds.enumerated() {
+            var result: Int32
+            if transfer.lengths[index] == 0 {
+                result = sendFileReject(carrier: self, fileid: fileId)
+            } else {
+                let part = transfer.partPaths[index] as NSString
+                result = sendFileSeek(carrier: self, fileid: fileId,
+                                      position: String(transfer.starts[index]))
+                if result >= 0 {
+                    result = sendFileAccept(carrier: self, fileid: fileId,
+                                            filename: part.lastPathComponent,
+                                            filepath: part.deletingLastPathComponent)
+                }
+            }
+
+            guard result >= 0 else {
+                let errno: Int = getErrorCode()
+                Log.e(Carrier.TAG, "Accept range \(index) of file \(transfer.filename) " +
+                    "error: 0x%X", errno)
+                _ = fileRanges.takeCompletion(transfer)
+                cancelFileRanges(transfer)
+                fileRanges.remove(transfer)
+                throw CarrierError.InternalError(errno: errno)
+            }
+
+            if transfer.lengths[index] == 0 {
+                didReceiveFileRange(fileRanges.didComplete(fileId).received, index)
+            }
+        }
+
+        Log.d(Carrier.TAG, "Accepted file \(transfer.filename) from \(transfer.friendId) " +
+            "in \(transfer.rangeCount) ranges.")
+    }
+
+    /// Reject a multi-range file from a friend.
+    ///
+    /// - Parameter transferId: The id of the multi-range file transfer
+    ///
+    /// - Throws: CarrierError
+    public func rejectMultiRangeFile(transferId: Int) throws {
+        guard let transfer = fileRanges.transfer(transferId), !transfer.isAccepted else {
+            throw CarrierError.InvalidArgument
+        }
+
+        for fileId in transfer.fileIds {
+            _ = sendFileReject(carrier: self, fileid: fileId)
+        }
+        fileRanges.remove(transfer)
+    }
+
+    /// Stop the transfer of a received range if it would run on towards
+    /// the end of file, then copy the range into place.
+    internal func didReceiveFileRange(_ transfer: FileRangeTransfer?, _ index: Int) {
+        guard let transfer = transfer else {
+            return
+        }
+
+        if index < transfer.rangeCount - 1 && transfer.lengths[index] > 0 {
+            _ = sendFileCancel(carrier: self, fileid: transfer.fileIds[index])
+        }
+        fileRanges.copy(transfer, index)
+    }
+
+    /// Hold back the file requests of a file announced by a friend, until
+    /// its ranges are listed or the announce expires.
+    internal func didReceiveFileRangeAnnounce(_ friendId: String,
+                                              _ bytes: UnsafeRawBufferPointer) {
+        guard let transfer = fileRanges.didReceiveAnnounce(friendId, bytes) else {
+            return
+        }
+
+        weak var weakSelf = self
+        _ = try? schedule(after: FileRangeAssembler.EXPECT_TIMEOUT) { _ in
+            guard let carrier = weakSelf else {
+                return
+            }
+
+            let (released, requested) = carrier.fileRanges.expire(transfer)
+            if !released.isEmpty || !requested.isEmpty {
+                Log.w(Carrier.TAG, "Multi-range file \(transfer.filename) from " +
+                    "\(friendId) expired.")
+            }
+
+            for fileId in requested {
+                _ = carrier.sendFileReject(carrier: carrier, fileid: fileId)
+            }
+            carrier.deliverFileRequests(released)
+        }
+    }
+
+    internal func didReceiveFileRangeList(_ friendId: String,
+                                          _ bytes: UnsafeRawBufferPointer) {
+        let (ready, released) = fileRanges.didReceiveList(friendId, bytes)
+
+        deliverFileRequests(released)
+        if let transfer = ready {
+            deliverMultiRangeFileRequest(transfer)
+        }
+    }
+
+    internal func deliverMultiRangeFileRequest(_ transfer: FileRangeTransfer) {
+        notifyDelegate(.MultiRangeFileRequest(transfer))
+    }
+
+    internal func deliverFileRequests(_ requests: [FileRangeRequest]) {
+        for request in requests {
+            notifyDelegate(.FileRequest(request))
+        }
+    }
+
+    internal func didFailFileRange(_ transfer: FileRangeTransfer?) {
+        guard let transfer = transfer else {
+            return
+        }
+
+        Log.w(Carrier.TAG, "Multi-range file \(transfer.filename) from " +
+            "\(transfer.friendId) failed.")
+
+        if let completion = fileRanges.takeCompletion(transfer) {
+            completion(nil, CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE)))
+        } else {
+            cancelFileRanges(transfer)
+            fileRanges.remove(transfer)
+        }
+    }
+
+    private func cancelFileRanges(_ transfer: FileRangeTransfer) {
+        for (index, fileId) in transfer.fileIds.enumerated() {
+            if !transfer.isAccepted || !transfer.done[index] {
+                _ = sendFileCancel(carrier: self, fileid: fileId)
+            }
         }
-        print("==fileId===")
-        return 0;
     }
 
     public func sendFileAccept(carrier: Carrier, fileid:String, filename:String, filepath:String) -> Int32 {
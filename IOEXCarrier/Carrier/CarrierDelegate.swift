@@ -107,6 +107,8 @@ public protocol CarrierDelegate {
 
     /// Tell the delegate that friend connection status has been changed.
     ///
+    /// Not invoked if the handle variant is implemented.
+    ///
     /// - Parameters:
     ///   - carrier: Carrier node instance
     ///   - friendId: The friend's user idza z z
@@ -119,8 +121,42 @@ public protocol CarrierDelegate {
                                    _ friendId: String,
                                    _ newStatus: CarrierConnectionStatus)
 
+    /// Tell the delegate that friend connection status has been changed,
+    /// with the friend given by handle.
+    ///
+    /// If implemented, the friend id variant is not invoked.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - friendHandle: The friend's handle
+    ///   - newStatus: The updated connection status of the friend
+    ///
+    /// - Returns: Void
+    @objc(carrier:friendHandle:connectionDidChange:) optional
+    func friendConnectionDidChange(_ carrier: Carrier,
+                                   friendHandle: Int,
+                                   _ newStatus: CarrierConnectionStatus)
+
+    /// Tell the delegate the net changes of friends' connection status and
+    /// presence over a coalescing window.
+    ///
+    /// Only invoked when event coalescing is enabled. If implemented, the
+    /// coalesced changes are not delivered to the per-friend connection
+    /// and presence methods.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - changes: The net changes, one per friend
+    ///
+    /// - Returns: Void
+    @objc(carrier:friendStatesDidChange:) optional
+    func friendStatesDidChange(_ carrier: Carrier,
+                               _ changes: [CarrierFriendStateChange])
+
     /// Tell the delegate that friend information has been changed.
     ///
+    /// Not invoked if the view variant is implemented.
+    ///
     /// - Parameters:
     ///   - carrier: Carrier node instance
     ///   - friendId: The friend's user id
@@ -132,8 +168,28 @@ public protocol CarrierDelegate {
                              _ friendId: String,
                              _ newInfo: CarrierFriendInfo)
 
+    /// Tell the delegate that friend information has been changed, with
+    /// a lazy view of the information.
+    ///
+    /// Fields of the view are decoded only when accessed. Call
+    /// `materialize()` on the view to keep the information. If
+    /// implemented, the other variant is not invoked.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - friendId: The friend's user id
+    ///   - view: The view of updated friend information
+    ///
+    /// - Returns: Void
+    @objc(carrier:friendInfoDidChange:newInfoView:) optional
+    func friendInfoDidChange(_ carrier: Carrier,
+                             _ friendId: String,
+                             view: CarrierFriendInfoView)
+
     /// Tell the delegate that friend presence has been changed.
     ///
+    /// Not invoked if the handle variant is implemented.
+    ///
     /// - Parameters:
     ///   - carrier: Carrier node instance
     ///   - friendId: The friend's user id
@@ -145,8 +201,26 @@ public protocol CarrierDelegate {
                                  _ friendId: String,
                                  _ newPresence: CarrierPresenceStatus)
 
+    /// Tell the delegate that friend presence has been changed, with the
+    /// friend given by handle.
+    ///
+    /// If implemented, the friend id variant is not invoked.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - friendHandle: The friend's handle
+    ///   - newPresence: The updated presence status of the friend
+    ///
+    /// - Returns: Void
+    @objc(carrier:friendHandle:presenceDidChange:) optional
+    func friendPresenceDidChange(_ carrier: Carrier,
+                                 friendHandle: Int,
+                                 _ newPresence: CarrierPresenceStatus)
+
     /// Tell the delegate that an friend request message has been received.
     ///
+    /// Not invoked if the view variant is implemented.
+    ///
     /// - Parameters:
     ///   - carrier: Carrier node instance
     ///   - userId: The user id who want be friend with current user
@@ -161,6 +235,27 @@ public protocol CarrierDelegate {
                                  _ userInfo: CarrierUserInfo,
                                  _ hello: String)
 
+    /// Tell the delegate that an friend request message has been received,
+    /// with a lazy view of the user information.
+    ///
+    /// Fields of the view are decoded only when accessed. Call
+    /// `materialize()` on the view to keep the information. If
+    /// implemented, the other variant is not invoked.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - userId: The user id who want be friend with current user
+    ///   - view: The view of user information to `userId`
+    ///   - hello: The PIN for target user, or any application defined
+    ///            content
+    ///
+    /// - Returns: Void
+    @objc(carrier:didReceiveFriendRequestFromUser:withUserInfoView:hello:) optional
+    func didReceiveFriendRequest(_ carrier: Carrier,
+                                 _ userId: String,
+                                 view: CarrierUserInfoView,
+                                 _ hello: String)
+
     /// Tell the delegate that an new friend has been added to current
     /// user's friend list.
     ///
@@ -186,6 +281,10 @@ public protocol CarrierDelegate {
 
     /// Tell the delegate that an friend message has been received.
     ///
+    /// Each message is delivered to one variant only. The data variant is
+    /// invoked if implemented, otherwise the handle variant, otherwise
+    /// this one. The text ends at the first NUL byte of the message.
+    ///
     /// - Parameters:
     ///   - carrier: Carrier node instance
     ///   - from: The id(userid@nodeid) from who send the message
@@ -197,6 +296,68 @@ public protocol CarrierDelegate {
                                  _ from: String,
                                  _ message: String)
 
+    /// Tell the delegate that an friend message has been received, with
+    /// the sender given by handle.
+    ///
+    /// Not invoked if the data variant is implemented.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - fromHandle: The handle of friend who send the message
+    ///   - message: The message content
+    ///
+    /// - Returns: Void
+    @objc(carrier:didReceiveFriendMessageFromHandle:withMessage:) optional
+    func didReceiveFriendMessage(_ carrier: Carrier,
+                                 fromHandle: Int,
+                                 _ message: String)
+
+    /// Tell the delegate that an friend message has been received, with
+    /// the message as binary data.
+    ///
+    /// The data holds the exact bytes received. Messages sent as text
+    /// include their NUL terminator. If implemented, the other variants
+    /// are not invoked.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - from: The id(userid@nodeid) from who send the message
+    ///   - data: The message content
+    ///
+    /// - Returns: Void
+    @objc(carrier:didReceiveFriendMessage:withData:) optional
+    func didReceiveFriendMessage(_ carrier: Carrier,
+                                 _ from: String,
+                                 data: Data)
+
+    /// Tell the delegate that the outbound queue of a friend has risen to
+    /// the high watermark.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - friendId: The friend's user id
+    ///   - depth: The number of messages queued to the friend
+    ///
+    /// - Returns: Void
+    @objc(carrier:outboundQueueDidReachHighWatermark:depth:) optional
+    func outboundQueueDidReachHighWatermark(_ carrier: Carrier,
+                                            _ friendId: String,
+                                            depth: Int)
+
+    /// Tell the delegate that the outbound queue of a friend has drained
+    /// to the low watermark after reaching the high watermark.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - friendId: The friend's user id
+    ///   - depth: The number of messages queued to the friend
+    ///
+    /// - Returns: Void
+    @objc(carrier:outboundQueueDidDrainToLowWatermark:depth:) optional
+    func outboundQueueDidDrainToLowWatermark(_ carrier: Carrier,
+                                             _ friendId: String,
+                                             depth: Int)
+
     /// Tell the delegate that an friend invite request has been received.
     ///
     /// - Parameters:
@@ -225,6 +386,31 @@ public protocol CarrierDelegate {
                             _ fileName: String,
                               filesize: Int)
     
+    /// Tell the delegate that a friend sends a file as several concurrent
+    /// range transfers.
+    ///
+    /// Accept it with `acceptMultiRangeFile(transferId:filepath:filename:
+    /// progress:completion:)` or reject it with
+    /// `rejectMultiRangeFile(transferId:)`. The file requests of the ranges
+    /// are not reported one by one.
+    ///
+    /// - Parameters:
+    ///   - carrier: Carrier node instance
+    ///   - transferId: The id of the multi-range file transfer
+    ///   - friendId: The friend's user id
+    ///   - fileName: The name of the file
+    ///   - filesize: The size of the file in bytes
+    ///   - rangeCount: The number of ranges
+    ///
+    /// - Returns: Void
+    @objc(carrier:didReceiveMultiRangeFileRequest:fromFriend:withFileName:withFileSize:withRangeCount:) optional
+    func didReceiveMultiRangeFileRequest(_ carrier: Carrier,
+                                         transferId: Int,
+                                         _ friendId: String,
+                                         _ fileName: String,
+                                         filesize: Int64,
+                                         rangeCount: Int)
+
     @objc(carrier:didReceiveFileAccepted:withFileIndex:withFilepath:withSize:)
     func didReceiveFileAccepted(carrier: Carrier,
                                  fileid: String,
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A delegate event converted from a native callback.
+///
+/// Events are plain records holding only the converted arguments, so
+/// queueing one into the event ring copies the record into its slot
+/// without allocating a closure context. The delegate method is chosen
+/// when the event is delivered.
+internal enum CarrierEvent {
+    case ConnectionStatus(CarrierConnectionStatus)
+    case Ready
+    case SelfUserInfo(CarrierUserInfo)
+    case FriendsList([CarrierFriendInfo])
+    case FriendConnection(Int, String, CarrierConnectionStatus)
+    case FriendInfo(String, CarrierFriendInfoView)
+    case FriendPresence(Int, String, CarrierPresenceStatus)
+    case FriendStates([CarrierFriendStateChange])
+    case FriendRequest(String, CarrierUserInfoView, String)
+    case FriendAdded(CarrierFriendInfoView)
+    case FriendRemoved(String)
+    case FriendMessage(Int, String, Data)
+    case FriendInvite(String, String)
+    case OutboundHighWatermark(String, Int)
+    case OutboundLowWatermark(String, Int)
+    case FileQueried(String, String, String)
+    case FileRequest(FileRangeRequest)
+    case MultiRangeFileRequest(FileRangeTransfer)
+    case FileAccepted(String, String, String, Int)
+    case FileRejected(String, String)
+    case FilePaused(String, String)
+    case FileResumed(String, String)
+    case FileCanceled(String, String)
+    case FileCompleted(String, String)
+    case FileProgress(String, String, String, UInt64, UInt64)
+    case FileAborted(String, String, String, Int, Int)
+
+    /// Invoke the delegate methods of the event.
+    internal func deliver(_ carrier: Carrier, _ handler: CarrierDelegate) {
+        switch self {
+        case .ConnectionStatus(let status):
+            handler.connectionStatusDidChange?(carrier, status)
+
+        case .Ready:
+            handler.didBecomeReady(carrier)
+
+        case .SelfUserInfo(let info):
+            handler.selfUserInfoDidChange?(carrier, info)
+
+        case .FriendsList(let friends):
+            handler.didReceiveFriendsList?(carrier, friends)
+
+        case .FriendConnection(let handle, let friendId, let status):
+            deliverConnection(carrier, handler, handle, friendId, status)
+
+        case .FriendInfo(let friendId, let view):
+            if handler.friendInfoDidChange?(carrier, friendId, view: view) == nil {
+                handler.friendInfoDidChange?(carrier, friendId, view.materialize())
+            }
+
+        case .FriendPresence(let handle, let friendId, let presence):
+            deliverPresence(carrier, handler, handle, friendId, presence)
+
+        case .FriendStates(let changes):
+            // The batched variant takes the whole window, and the per-friend
+            // variants get the changes only if it is not implemented.
+            guard handler.friendStatesDidChange?(carrier, changes) == nil else {
+                break
+            }
+
+            for change in changes {
+                if change.statusChanged {
+                    deliverConnection(carrier, handler, change.friendHandle,
+                                      change.friendId, change.status)
+                }
+                if change.presenceChanged {
+                    deliverPresence(carrier, handler, change.friendHandle,
+                                    change.friendId, change.presence)
+                }
+            }
+
+        case .FriendRequest(let userId, let view, let hello):
+            if handler.didReceiveFriendRequest?(carrier, userId, view: view, hello) == nil {
+                handler.didReceiveFriendRequest?(carrier, userId, view.materialize(), hello)
+            }
+
+        case .FriendAdded(let view):
+            handler.newFriendAdded?(carrier, view.materialize())
+
+        case .FriendRemoved(let friendId):
+            handler.friendRemoved?(carrier, friendId)
+
+        case .FriendMessage(let handle, let from, let data):
+            // Only the first implemented variant gets the message, in the
+            // order data, handle, then text.
+            guard handler.didReceiveFriendMessage?(carrier, from, data: data) == nil else {
+                break
+            }
+
+            // Text messages end at the first NUL, as the C string they were.
+            let end = data.index(of: 0) ?? data.endIndex
+            let message = String(decoding: data[data.startIndex..<end], as: UTF8.self)
+
+            if handler.didReceiveFriendMessage?(carrier, fromHandle: handle, message) == nil {
+                handler.didReceiveFriendMessage?(carrier, from, message)
+            }
+
+        case .FriendInvite(let from, let data):
+            handler.didReceiveFriendInviteRequest?(carrier, from, data)
+
+        case .OutboundHighWatermark(let friendId, let depth):
+            handler.outboundQueueDidReachHighWatermark?(carrier, friendId, depth: depth)
+
+        case .OutboundLowWatermark(let friendId, let depth):
+            handler.outboundQueueDidDrainToLowWatermark?(carrier, friendId, depth: depth)
+
+        case .FileQueried(let friendId, let filename, let message):
+            handler.didReceiveFileQueried(carrier: carrier, friendId, filename,
+                                          message: message)
+
+        case .FileRequest(let request):
+            handler.didReceiveFileRequest(carrier: carrier, fileid: request.fileId,
+                                          request.friendId, request.filename,
+                                          filesize: request.filesize)
+
+        case .MultiRangeFileRequest(let transfer):
+            handler.didReceiveMultiRangeFileRequest?(carrier,
+                                                     transferId: transfer.transferId,
+                                                     transfer.friendId, transfer.filename,
+                                                     filesize: transfer.filesize,
+                                                     rangeCount: transfer.rangeCount)
+
+        case .FileAccepted(let fileId, let friendId, let fullpath, let filesize):
+            handler.didReceiveFileAccepted(carrier: carrier, fileid: fileId,
+                                           friendId: friendId, fullpath: fullpath,
+                                           size_t: filesize)
+
+        case .FileRejected(let fileId, let friendId):
+            handler.didReceiveFileRejected(carrier: carrier, fileId, friendid: friendId)
+
+        case .FilePaused(let fileId, let friendId):
+            handler.didReceiveFilePaused(carrier: carrier, fileId, friendid: friendId)
+
+        case .FileResumed(let fileId, let friendId):
+            handler.didReceiveFileResumed(carrier: carrier, fileId, friendid: friendId)
+
+        case .FileCanceled(let fileId, let friendId):
+            handler.didReceiveFileCanceled(carrier: carrier, fileId, friendid: friendId)
+
+        case .FileCompleted(let fileId, let friendId):
+            handler.didReceiveFileCompleted(carrier: carrier, fileId, friendid: friendId)
+
+        case .FileProgress(let fileId, let friendId, let fullpath, let size, let transferred):
+            handler.didReceiveFileProgress(carrier: carrier, fileId, friendid: friendId,
+                                           fullpath: fullpath, size: Int64(size),
+                                           transferred: Int64(transferred))
+
+        case .FileAborted(let fileId, let friendId, let filename, let length, let filesize):
+            handler.didReceiveFileAborted(carrier: carrier, fileId, friendid: friendId,
+                                          filename: filename, length: length,
+                                          filesize: filesize)
+        }
+    }
+
+    /// Invoke the handle variant of the connection delegate method, or the
+    /// friend id variant if the handle one is not implemented.
+    private func deliverConnection(_ carrier: Carrier, _ handler: CarrierDelegate,
+                                   _ handle: Int, _ friendId: String,
+                                   _ status: CarrierConnectionStatus) {
+        if handler.friendConnectionDidChange?(carrier, friendHandle: handle, status) == nil {
+            handler.friendConnectionDidChange?(carrier, friendId, status)
+        }
+    }
+
+    /// Invoke the handle variant of the presence delegate method, or the
+    /// friend id variant if the handle one is not implemented.
+    private func deliverPresence(_ carrier: Carrier, _ handler: CarrierDelegate,
+                                 _ handle: Int, _ friendId: String,
+                                 _ presence: CarrierPresenceStatus) {
+        if handler.friendPresenceDidChange?(carrier, friendHandle: handle, presence) == nil {
+            handler.friendPresenceDidChange?(carrier, friendId, presence)
+        }
+    }
+}
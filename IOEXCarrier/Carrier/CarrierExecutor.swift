@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    CarrierExecutor decides on which thread the native event loop of carrier
+    node runs.
+
+    All native callbacks of a carrier node are invoked on the loop thread,
+    so the executor should not be shared with other long running work.
+ */
+@objc(ELACarrierExecutor)
+public class CarrierExecutor: NSObject {
+
+    private let executeBlock: (@escaping () -> Void) -> Void
+
+    private init(_ executeBlock: @escaping (@escaping () -> Void) -> Void) {
+        self.executeBlock = executeBlock
+        super.init()
+    }
+
+    /// Create an executor running event loop on a new serial dispatch queue.
+    ///
+    /// - Parameters:
+    ///   - label: The label of the dispatch queue
+    ///   - qos: The quality of service of the dispatch queue
+    ///
+    /// - Returns: The executor
+    public static func dispatchQueue(label: String = "org.elastos.queue",
+                                     qos: DispatchQoS = .background) -> CarrierExecutor {
+        return CarrierExecutor() { (work) in
+            DispatchQueue(label: label, qos: qos, target: nil).async(execute: work)
+        }
+    }
+
+    /// Create an executor running event loop on application supplied
+    /// dispatch queue.
+    ///
+    /// - Parameter queue: The dispatch queue
+    ///
+    /// - Returns: The executor
+    public static func queue(_ queue: DispatchQueue) -> CarrierExecutor {
+        return CarrierExecutor() { (work) in
+            queue.async(execute: work)
+        }
+    }
+
+    /// Create an executor running event loop on a dedicated thread.
+    ///
+    /// iOS does not offer thread to CPU affinity, the dedicated thread is
+    /// only scheduled with the specified quality of service and priority.
+    ///
+    /// - Parameters:
+    ///   - name: The name of the thread
+    ///   - qualityOfService: The quality of service of the thread
+    ///   - priority: The thread priority, from 0.0 to 1.0
+    ///   - stackSize: The stack size of the thread in bytes, or 0 to use
+    ///                the system default
+    ///
+    /// - Returns: The executor
+    @objc(threadWithName:qualityOfService:priority:stackSize:)
+    public static func thread(name: String = "org.elastos.thread",
+                              qualityOfService: QualityOfService = .userInitiated,
+                              priority: Double = 0.5,
+                              stackSize: Int = 0) -> CarrierExecutor {
+        return CarrierExecutor() { (work) in
+            let runner = ThreadRunner(work)
+            let thread = Thread(target: runner,
+                                selector: #selector(ThreadRunner.run),
+                                object: nil)
+            thread.name = name
+            thread.qualityOfService = qualityOfService
+            thread.threadPriority = priority
+            if stackSize > 0 {
+                thread.stackSize = stackSize
+            }
+            thread.start()
+        }
+    }
+
+    internal func execute(_ work: @escaping () -> Void) {
+        executeBlock(work)
+    }
+}
+
+private class ThreadRunner: NSObject {
+    private let work: () -> Void
+
+    init(_ work: @escaping () -> Void) {
+        self.work = work
+        super.init()
+    }
+
+    @objc func run() {
+        work()
+    }
+}
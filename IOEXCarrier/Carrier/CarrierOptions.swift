@@ -52,6 +52,7 @@ import Foundation
 public class CarrierOptions: NSObject {
     private var _persistentLocation: String?
     private var _udpEnabled: Bool = true
+    private var _bootstrapCacheEnabled: Bool = false
 
     private var _bootstrapNodes: [BootstrapNode]?
 
@@ -82,6 +83,21 @@ public class CarrierOptions: NSObject {
         }
     }
 
+    /**
+        The option to keep a scored cache of bootstrap nodes that recently
+        led carrier node to connect, under the persistent location. Cached
+        nodes are tried ahead of the configured bootstrap nodes on next start,
+        and dropped once they stop leading carrier node to connect.
+     */
+    public var bootstrapCacheEnabled: Bool {
+        set {
+            _bootstrapCacheEnabled = newValue
+        }
+        get {
+            return _bootstrapCacheEnabled
+        }
+    }
+
     public var bootstrapNodes: [BootstrapNode]? {
         set {
             _bootstrapNodes = newValue
@@ -92,13 +108,14 @@ public class CarrierOptions: NSObject {
     }
 }
 
-internal func convertCarrierOptionsToCOptions(_ options : CarrierOptions) -> COptions {
+internal func convertCarrierOptionsToCOptions(_ options : CarrierOptions,
+                                              _ bootstrapNodes: [BootstrapNode]? = nil) -> COptions {
     var cOptions = COptions()
     var cNodes: UnsafeMutablePointer<CBootstrapNode>?
 
     cOptions.persistent_location = createCStringDuplicate(options.persistentLocation)
     cOptions.udp_enabled = options.udpEnabled
-    (cNodes, cOptions.bootstraps_size) = convertBootstrapNodesToCBootstrapNodes(options.bootstrapNodes!)
+    (cNodes, cOptions.bootstraps_size) = convertBootstrapNodesToCBootstrapNodes(bootstrapNodes ?? options.bootstrapNodes!)
 
     cOptions.bootstraps = UnsafePointer<CBootstrapNode>(cNodes)
 
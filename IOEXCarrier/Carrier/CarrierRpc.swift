@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+public typealias CarrierRpcMethodHandler =
+    (_ carrier: Carrier, _ from: String, _ params: String, _ reply: CarrierRpcReply) -> Void
+
+public typealias CarrierRpcResponseHandler =
+    (_ carrier: Carrier, _ status: Int, _ reason: String?, _ result: String?) -> Void
+
+/// The class representing the RPC endpoint of carrier node, carried over
+/// friend invite requests.
+///
+/// Each call carries a method name and a call id in the invite data, and
+/// the reply echoes the call id, so any number of calls can be pending to
+/// the same friend and replies are matched to their calls in any order.
+@objc(ELACarrierRpc)
+public class CarrierRpc: NSObject {
+
+    /// The status replied to calls of methods not registered by the peer.
+    public static let METHOD_NOT_FOUND_STATUS: Int = -32601
+
+    private static let TAG: String = "CarrierRpc"
+
+    private unowned let carrier: Carrier
+    private let callSequence: UnsafeMutablePointer<Int32>
+    private var methods: [String: CarrierRpcMethodHandler]
+    private var pending: [Int: (handler: CarrierRpcResponseHandler, timer: CarrierTimer?)]
+    private var active: Bool = false
+
+    internal init(_ carrier: Carrier) {
+        self.carrier = carrier
+        self.callSequence = UnsafeMutablePointer<Int32>.allocate(capacity: 1)
+        self.callSequence.initialize(to: 0, count: 1)
+        self.methods = [String: CarrierRpcMethodHandler]()
+        self.pending = [Int: (handler: CarrierRpcResponseHandler, timer: CarrierTimer?)]()
+        super.init()
+    }
+
+    deinit {
+        callSequence.deinitialize(count: 1)
+        callSequence.deallocate(capacity: 1)
+    }
+
+    /// Register the handler of a method called by friends.
+    ///
+    /// The handler is invoked on `delegateQueue`, or the loop thread if no
+    /// delegate queue is set, and can reply at any time later.
+    ///
+    /// - Parameters:
+    ///   - method: The method name, without whitespaces
+    ///   - handler: The handler of the method, or nil to unregister it
+    ///
+    /// - Throws: CarrierError
+    public func register(method: String, handler: CarrierRpcMethodHandler?) throws {
+        guard RpcEnvelope.isValid(method: method) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        objc_sync_enter(self)
+        methods[method] = handler
+        objc_sync_exit(self)
+    }
+
+    /// Call a method of the specified friend.
+    ///
+    /// Calls do not wait for each other, so calls to the same friend are
+    /// pipelined and their replies may arrive in any order.
+    ///
+    /// - Parameters:
+    ///   - target: The target id
+    ///   - method: The method name, without whitespaces
+    ///   - params: The parameters of the call defined by application
+    ///   - timeout: The time to wait for the reply, in seconds, or 0 to
+    ///              wait forever. At most about 46 hours
+    ///   - responseHandler: The handler to receive the reply
+    ///
+    /// - Returns: The call id, to cancel the call with
+    ///
+    /// - Throws: CarrierError
+    @discardableResult
+    public func call(_ target: String, method: String, params: String,
+                     timeout: TimeInterval = 0,
+                     responseHandler: @escaping CarrierRpcResponseHandler) throws -> Int {
+        guard RpcEnvelope.isValid(method: method) && carrier.isSchedulable(timeout) else {
+            throw CarrierError.InvalidArgument
+        }
+
+        let callId = Int(OSAtomicIncrement32Barrier(callSequence) & Int32.max)
+
+        objc_sync_enter(self)
+        pending[callId] = (responseHandler, nil)
+        objc_sync_exit(self)
+
+        weak var weakSelf = self
+        do {
+            try carrier.sendInviteFriendRequest(to: target,
+                withData: RpcEnvelope.call(callId, method, params), timeout: timeout) {
+                (_, _, status, reason, data) in
+                weakSelf?.didReceiveResponse(callId, status, reason, data)
+            }
+        } catch let error {
+            objc_sync_enter(self)
+            pending[callId] = nil
+            objc_sync_exit(self)
+            throw error
+        }
+
+        // The invite request expires by itself too, but the reply of this
+        // call may arrive with the invite response of another call, so the
+        // call keeps its own timer.
+        if timeout > 0 {
+            let timer: CarrierTimer
+            do {
+                timer = try carrier.schedule(after: timeout) { _ in
+                    weakSelf?.complete(callId, CarrierRequest.TIMEOUT_STATUS,
+                                       CarrierRequest.TIMEOUT_REASON, nil)
+                }
+            } catch let error {
+                cancel(callId: callId)
+                throw error
+            }
+
+            objc_sync_enter(self)
+            if pending[callId] != nil {
+                pending[callId]!.timer = timer
+            } else {
+                timer.cancel()
+            }
+            objc_sync_exit(self)
+        }
+
+        return callId
+    }
+
+    /// Cancel a pending call. Its response handler will not be invoked
+    /// even if the reply arrives later.
+    ///
+    /// - Parameter callId: The call id
+    public func cancel(callId: Int) {
+        objc_sync_enter(self)
+        let call = pending.removeValue(forKey: callId)
+        objc_sync_exit(self)
+
+        call?.timer?.cancel()
+    }
+
+    /// Get the number of calls waiting for their replies.
+    ///
+    /// - Returns: The number of pending calls
+    public func getPendingCallCount() -> Int {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return pending.count
+    }
+
+    /// Handle a friend invite request carrying a call, on the loop thread.
+    ///
+    /// - Returns: Whether the invite was an RPC call
+    internal func activate() {
+        objc_sync_enter(self)
+        active = true
+        objc_sync_exit(self)
+    }
+
+    internal func handleInvite(_ from: String, _ data: String) -> Bool {
+        guard let envelope = RpcEnvelope.parse(data),
+            let method = envelope.method else {
+            return false
+        }
+
+        objc_sync_enter(self)
+        let isActive = active
+        let handler = methods[method]
+        objc_sync_exit(self)
+
+        guard isActive else {
+            return false
+        }
+
+        let reply = CarrierRpcReply(carrier, from, envelope.callId)
+
+        guard let methodHandler = handler else {
+            Log.w(CarrierRpc.TAG, "RPC method \(method) called by \(from) not found.")
+            try? reply.fail(status: CarrierRpc.METHOD_NOT_FOUND_STATUS,
+                            reason: "Method not found")
+            return true
+        }
+
+        let carrier = self.carrier
+        carrier.dispatchToDelegateQueue {
+            methodHandler(carrier, from, envelope.body, reply)
+        }
+        return true
+    }
+
+    private func didReceiveResponse(_ sentId: Int, _ status: Int,
+                                    _ reason: String?, _ data: String?) {
+        guard status != CarrierRequest.TIMEOUT_STATUS else {
+            return
+        }
+
+        var callId = sentId
+        var reason = reason
+        var result = data
+
+        // Replies carry the call id, as the native node may pair a reply
+        // with the invite request of another call to the same friend.
+        if let envelope = RpcEnvelope.parse((status == 0 ? data : reason) ?? "") {
+            callId = envelope.callId
+            if status == 0 {
+                result = envelope.body
+            } else {
+                reason = envelope.body
+            }
+        }
+
+        complete(callId, status, reason, result)
+    }
+
+    private func complete(_ callId: Int, _ status: Int,
+                          _ reason: String?, _ result: String?) {
+        objc_sync_enter(self)
+        let call = pending.removeValue(forKey: callId)
+        objc_sync_exit(self)
+
+        guard let pendingCall = call else {
+            return
+        }
+
+        pendingCall.timer?.cancel()
+
+        let carrier = self.carrier
+        if status == CarrierRequest.TIMEOUT_STATUS {
+            carrier.dispatchToDelegateQueue {
+                pendingCall.handler(carrier, status, reason, result)
+            }
+        } else {
+            pendingCall.handler(carrier, status, reason, result)
+        }
+    }
+}
+
+/// The class to reply a call received by the RPC endpoint.
+@objc(ELACarrierRpcReply)
+public class CarrierRpcReply: NSObject {
+
+    private weak var carrier: Carrier?
+    private let target: String
+    private let callId: Int
+    private var replied: Bool = false
+
+    internal init(_ carrier: Carrier, _ target: String, _ callId: Int) {
+        self.carrier = carrier
+        self.target = target
+        self.callId = callId
+        super.init()
+    }
+
+    /// Reply the call with success.
+    ///
+    /// - Parameter result: The result of the call defined by application
+    ///
+    /// - Throws: CarrierError
+    public func succeed(result: String) throws {
+        try reply(0, nil, RpcEnvelope.reply(callId, result))
+    }
+
+    /// Reply the call with failure.
+    ///
+    /// - Parameters:
+    ///   - status: The error status of the call, not 0
+    ///   - reason: The error message
+    ///
+    /// - Throws: CarrierError
+    public func fail(status: Int, reason: String) throws {
+        guard status != 0 else {
+            throw CarrierError.InvalidArgument
+        }
+
+        try reply(status, RpcEnvelope.reply(callId, reason), nil)
+    }
+
+    private func reply(_ status: Int, _ reason: String?, _ data: String?) throws {
+        objc_sync_enter(self)
+        let didReply = replied
+        replied = true
+        objc_sync_exit(self)
+
+        guard !didReply, let carrier = carrier else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+        }
+
+        try carrier.replyFriendInviteRequest(to: target, withStatus: status,
+                                             reason: reason, data: data)
+    }
+}
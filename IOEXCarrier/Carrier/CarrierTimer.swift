@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+public typealias CarrierTimerHandler = (_ timer: CarrierTimer) -> Void
+
+/// The class representing a timer scheduled on carrier event loop.
+@objc(ELACarrierTimer)
+public class CarrierTimer: NSObject {
+
+    internal let handler: CarrierTimerHandler?
+    internal let interval: UInt64
+    internal let repeats: Bool
+    internal var expires: UInt64 = 0
+
+    internal var prev: CarrierTimer?
+    internal var next: CarrierTimer?
+
+    private weak var carrier: Carrier?
+    private var _cancelled: Bool = false
+
+    internal init(_ carrier: Carrier?, _ interval: UInt64, _ repeats: Bool,
+                  _ handler: CarrierTimerHandler?) {
+        self.carrier = carrier
+        self.interval = interval
+        self.repeats = repeats
+        self.handler = handler
+        super.init()
+    }
+
+    /// Whether the timer has been cancelled.
+    public var isCancelled: Bool {
+        return _cancelled
+    }
+
+    /// Cancel the timer. The handler will not be invoked any more once the
+    /// method returns on the loop thread, or after the next loop iteration
+    /// if called from other threads.
+    public func cancel() {
+        _cancelled = true
+        carrier?.unscheduleTimer(self)
+    }
+
+    internal var isLinked: Bool {
+        return prev != nil
+    }
+
+    internal func unlink() {
+        prev?.next = next
+        next?.prev = prev
+        prev = nil
+        next = nil
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    The friends changed since a revision of the friend list.
+ */
+@objc(ELACarrierFriendChanges)
+public class CarrierFriendChanges: NSObject {
+
+    /// The current revision of the friend list. Pass it to the next
+    /// query to get further changes.
+    public let revision: UInt64
+
+    /// The friends added or changed since the given revision.
+    public let changed: [CarrierFriendInfo]
+
+    /// The ids of friends removed since the given revision.
+    public let removed: [String]
+
+    /// Whether the given revision was too old to compute a delta. The
+    /// changed list then holds all friends, and friends not in it should
+    /// be considered removed.
+    public let isFullSnapshot: Bool
+
+    internal init(_ revision: UInt64, _ changed: [CarrierFriendInfo],
+                  _ removed: [String], _ isFullSnapshot: Bool) {
+        self.revision = revision
+        self.changed = changed
+        self.removed = removed
+        self.isFullSnapshot = isFullSnapshot
+        super.init()
+    }
+
+    public override var description: String {
+        return String(format: "FriendChanges: revision[%llu], changed[%ld], " +
+                      "removed[%ld], isFullSnapshot[%@]",
+                      revision, changed.count, removed.count,
+                      isFullSnapshot.description)
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    A lazy view of carrier friend information.
+
+    The view keeps the native friend information, and decodes each
+    field only when it is accessed. Use `materialize()` to get a
+    `CarrierFriendInfo` for long-term storage.
+
+    The native information is copied into the view on creation and never
+    changed, so a view may be read from any thread.
+ */
+@objc(ELACarrierFriendInfoView)
+public class CarrierFriendInfoView: NSObject {
+
+    private let cinfo: UnsafeMutablePointer<CFriendInfo>
+    private var materialized: CarrierFriendInfo?
+
+    internal init(_ cinfo: CFriendInfo) {
+        self.cinfo = UnsafeMutablePointer<CFriendInfo>.allocate(capacity: 1)
+        self.cinfo.initialize(to: cinfo)
+        super.init()
+    }
+
+    deinit {
+        cinfo.deinitialize()
+        cinfo.deallocate(capacity: 1)
+    }
+
+    /// User ID of friend.
+    public var userId: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.userid)
+    }
+
+    /// Nickname of friend, also known as display name.
+    public var name: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.name)
+    }
+
+    /// Friend's brief description, also known as what's up.
+    public var briefDescription: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.description)
+    }
+
+    /// Whether friend has an avatar.
+    public var hasAvatar: Bool {
+        return cinfo.pointee.user_info.has_avatar != 0
+    }
+
+    /// Friend's gender.
+    public var gender: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.gender)
+    }
+
+    /// Friend's phone number.
+    public var phone: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.phone)
+    }
+
+    /// Friend's email address.
+    public var email: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.email)
+    }
+
+    /// Friend's region information.
+    public var region: String? {
+        return String(cCharPointer: &cinfo.pointee.user_info.region)
+    }
+
+    /// Label name for the friend.
+    public var label: String? {
+        return String(cCharPointer: &cinfo.pointee.label)
+    }
+
+    /// Friend's connection status.
+    public var status: CarrierConnectionStatus {
+        return convertCConnectionStatusToCarrierConnectionStatus(cinfo.pointee.status)
+    }
+
+    /// Friend's presence status.
+    public var presence: CarrierPresenceStatus {
+        return convertCPresenceStatusToCarrierPresenceStatus(cinfo.pointee.presence)
+    }
+
+    /// Decode all fields into friend information. The result is decoded
+    /// once and shared by later calls.
+    ///
+    /// - Returns: The friend information
+    public func materialize() -> CarrierFriendInfo {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        if materialized == nil {
+            materialized = convertCFriendInfoToCarrierFriendInfo(cinfo.pointee)
+        }
+        return materialized!
+    }
+
+    internal func updated(status: CarrierConnectionStatus) -> CarrierFriendInfoView {
+        var newInfo = cinfo.pointee
+        newInfo.status = Int32(status.rawValue)
+        return CarrierFriendInfoView(newInfo)
+    }
+
+    internal func updated(presence: CarrierPresenceStatus) -> CarrierFriendInfoView {
+        var newInfo = cinfo.pointee
+        newInfo.presence = Int32(presence.rawValue)
+        return CarrierFriendInfoView(newInfo)
+    }
+
+    public override var description: String {
+        return materialize().description
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    The net change of a friend's connection status and presence over a
+    coalescing window.
+ */
+@objc(ELACarrierFriendStateChange)
+public class CarrierFriendStateChange: NSObject {
+
+    /// The friend's user id.
+    public let friendId: String
+
+    /// The friend's handle.
+    public let friendHandle: Int
+
+    /// The final connection status of the friend.
+    public let status: CarrierConnectionStatus
+
+    /// The final presence status of the friend.
+    public let presence: CarrierPresenceStatus
+
+    /// Whether the connection status differs from the one before the
+    /// window.
+    public let statusChanged: Bool
+
+    /// Whether the presence status differs from the one before the window.
+    public let presenceChanged: Bool
+
+    internal init(_ friendId: String, _ friendHandle: Int,
+                  _ status: CarrierConnectionStatus, _ statusChanged: Bool,
+                  _ presence: CarrierPresenceStatus, _ presenceChanged: Bool) {
+        self.friendId = friendId
+        self.friendHandle = friendHandle
+        self.status = status
+        self.statusChanged = statusChanged
+        self.presence = presence
+        self.presenceChanged = presenceChanged
+        super.init()
+    }
+
+    public override var description: String {
+        return String(format: "FriendStateChange: friendId[%@], " +
+                      "status[%@], statusChanged[%@], " +
+                      "presence[%@], presenceChanged[%@]",
+                      friendId, status.description, statusChanged.description,
+                      presence.description, presenceChanged.description)
+    }
+}
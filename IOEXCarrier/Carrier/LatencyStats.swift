@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    The round-trip times measured by probes to a friend.
+ */
+@objc(ELACarrierLatencyStats)
+public class CarrierLatencyStats: NSObject {
+
+    /// The friend's user id.
+    public let friendId: String
+
+    /// The number of probes sent to the friend.
+    public let sent: Int
+
+    /// The number of probes answered by the friend.
+    public let received: Int
+
+    /// The shortest RTT, in milliseconds.
+    public let minRtt: Double
+
+    /// The longest RTT, in milliseconds.
+    public let maxRtt: Double
+
+    /// The mean RTT, in milliseconds.
+    public let meanRtt: Double
+
+    /// The median RTT, as the upper bound of its bucket in milliseconds.
+    public let p50Rtt: Int
+
+    /// The 99th percentile RTT, as the upper bound of its bucket in
+    /// milliseconds.
+    public let p99Rtt: Int
+
+    /// The RTT histogram. Bucket 0 counts RTTs below 1 millisecond, and
+    /// bucket `i` counts RTTs from 2^(i-1) up to 2^i milliseconds. The last
+    /// bucket counts all longer RTTs.
+    public let buckets: [Int]
+
+    internal init(_ friendId: String, _ histogram: LatencyHistogram,
+                  _ sent: Int, _ received: Int) {
+        self.friendId = friendId
+        self.sent = sent
+        self.received = received
+        self.minRtt = histogram.count > 0 ? Double(histogram.minMicros) / 1000 : 0
+        self.maxRtt = Double(histogram.maxMicros) / 1000
+        self.meanRtt = histogram.count > 0 ?
+            Double(histogram.sumMicros) / Double(histogram.count) / 1000 : 0
+        self.p50Rtt = histogram.percentile(0.5)
+        self.p99Rtt = histogram.percentile(0.99)
+        self.buckets = histogram.buckets
+        super.init()
+    }
+
+    public override var description: String {
+        return String(format: "LatencyStats: friendId[%@], sent[%ld], received[%ld], " +
+                      "min[%.3f], max[%.3f], mean[%.3f], p50[%ld], p99[%ld]",
+                      friendId, sent, received, minRtt, maxRtt, meanRtt,
+                      p50Rtt, p99Rtt)
+    }
+}
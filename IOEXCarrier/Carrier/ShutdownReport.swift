@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    A report of how long each phase of carrier node shutdown took.
+ */
+@objc(ELACarrierShutdownReport)
+public class CarrierShutdownReport: NSObject {
+
+    /// Time spent closing all sessions of carrier node, in seconds.
+    public let closingSessions: TimeInterval
+
+    /// Time spent in native node teardown, leaving carrier network, in
+    /// seconds.
+    public let leavingNetwork: TimeInterval
+
+    /// Time spent waiting for the native event loop to flush persistent
+    /// data and exit, in seconds.
+    public let flushingPersistentData: TimeInterval
+
+    /// Total time of the shutdown, in seconds.
+    public let total: TimeInterval
+
+    /// Whether the deadline ran out before the native event loop exited.
+    /// The loop then finishes in the background.
+    public let forced: Bool
+
+    internal init(closingSessions: TimeInterval, leavingNetwork: TimeInterval,
+                  flushingPersistentData: TimeInterval, forced: Bool) {
+        self.closingSessions = closingSessions
+        self.leavingNetwork = leavingNetwork
+        self.flushingPersistentData = flushingPersistentData
+        self.total = closingSessions + leavingNetwork + flushingPersistentData
+        self.forced = forced
+        super.init()
+    }
+
+    public override var description: String {
+        return String(format: "ShutdownReport: closingSessions[%.3fs], " +
+                      "leavingNetwork[%.3fs], flushingPersistentData[%.3fs], " +
+                      "total[%.3fs], forced[%@]",
+                      closingSessions, leavingNetwork, flushingPersistentData,
+                      total, forced.description)
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+internal enum StartupMark: Int {
+    case Creating = 0
+    case Created
+    case Starting
+    case LoopStarted
+    case Connected
+    case FriendConnected
+    case Ready
+
+    internal static let count: Int = 7
+}
+
+/**
+    A trace of carrier node startup, from native node creation to ready.
+
+    All times are in seconds on the monotonic clock, measured from the
+    moment carrier node began to be created. A phase not reached yet is nil.
+ */
+@objc(ELACarrierStartupTrace)
+public class CarrierStartupTrace: NSObject {
+
+    /// Whether persistent data existed before carrier node was created.
+    public let warmStart: Bool
+
+    /// Time when native node creation finished. It covers persistent data
+    /// loading and key derivation, which are not separable in native node.
+    public let created: TimeInterval?
+
+    /// Time when carrier node was asked to start.
+    public let starting: TimeInterval?
+
+    /// Time when the native event loop ran its first iteration.
+    public let loopStarted: TimeInterval?
+
+    /// Time when carrier node first connected to carrier network, after
+    /// bootstrap nodes responded.
+    public let connected: TimeInterval?
+
+    /// Time when the first friend reconnected.
+    public let friendConnected: TimeInterval?
+
+    /// Time when carrier node became ready.
+    public let ready: TimeInterval?
+
+    internal init(_ marks: UnsafeMutablePointer<UInt64>, _ warmStart: Bool) {
+        func time(_ mark: StartupMark) -> TimeInterval? {
+            let origin = marks[StartupMark.Creating.rawValue]
+            let value = marks[mark.rawValue]
+            guard origin > 0 && value >= origin else {
+                return nil
+            }
+            return TimeInterval(value - origin) / 1_000_000_000
+        }
+
+        self.warmStart = warmStart
+        self.created = time(.Created)
+        self.starting = time(.Starting)
+        self.loopStarted = time(.LoopStarted)
+        self.connected = time(.Connected)
+        self.friendConnected = time(.FriendConnected)
+        self.ready = time(.Ready)
+        super.init()
+    }
+
+    public override var description: String {
+        func format(_ value: TimeInterval?) -> String {
+            return value != nil ? String(format: "%.3fs", value!) : "-"
+        }
+
+        return "StartupTrace: warmStart[\(warmStart)], " +
+               "created[\(format(created))], starting[\(format(starting))], " +
+               "loopStarted[\(format(loopStarted))], " +
+               "connected[\(format(connected))], " +
+               "friendConnected[\(format(friendConnected))], " +
+               "ready[\(format(ready))]"
+    }
+}
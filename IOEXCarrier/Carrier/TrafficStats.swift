@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    The traffic counters of carrier node or of one friend.
+ */
+@objc(ELACarrierTrafficStats)
+public class CarrierTrafficStats: NSObject {
+
+    /// The number of friend messages sent, counting each fragment.
+    public let messagesSent: Int
+
+    /// The number of friend message bytes sent.
+    public let bytesSent: Int
+
+    /// The number of friend messages received, counting each fragment.
+    public let messagesReceived: Int
+
+    /// The number of friend message bytes received.
+    public let bytesReceived: Int
+
+    /// The number of friend messages failed to send, by error code.
+    public let sendFailures: [Int: Int]
+
+    /// The number of friend invite requests sent.
+    public let invitesSent: Int
+
+    /// The number of friend invite requests received.
+    public let invitesReceived: Int
+
+    /// The number of file bytes transferred in either direction.
+    public let fileBytes: Int
+
+    internal init(_ counters: TrafficCounters.Counters) {
+        self.messagesSent = counters.messagesSent
+        self.bytesSent = counters.bytesSent
+        self.messagesReceived = counters.messagesReceived
+        self.bytesReceived = counters.bytesReceived
+        self.sendFailures = counters.sendFailures
+        self.invitesSent = counters.invitesSent
+        self.invitesReceived = counters.invitesReceived
+        self.fileBytes = counters.fileBytes
+        super.init()
+    }
+
+    /// The total number of friend messages failed to send.
+    public var sendFailureCount: Int {
+        return sendFailures.values.reduce(0, +)
+    }
+
+    public override var description: String {
+        return String(format: "TrafficStats: messagesSent[%ld], bytesSent[%ld], " +
+                      "messagesReceived[%ld], bytesReceived[%ld], sendFailures[%ld], " +
+                      "invitesSent[%ld], invitesReceived[%ld], fileBytes[%ld]",
+                      messagesSent, bytesSent, messagesReceived, bytesReceived,
+                      sendFailureCount, invitesSent, invitesReceived, fileBytes)
+    }
+}
+
+/**
+    A consistent snapshot of the traffic counters of carrier node and of
+    all friends.
+ */
+@objc(ELACarrierTrafficSnapshot)
+public class CarrierTrafficSnapshot: NSObject {
+
+    /// The counters of carrier node, summed over all friends.
+    public let node: CarrierTrafficStats
+
+    /// The counters of friends with any traffic, by friend id.
+    public let friends: [String: CarrierTrafficStats]
+
+    internal init(_ node: CarrierTrafficStats,
+                  _ friends: [String: CarrierTrafficStats]) {
+        self.node = node
+        self.friends = friends
+        super.init()
+    }
+
+    public override var description: String {
+        return String(format: "TrafficSnapshot: friends[%ld], ", friends.count) +
+            node.description
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/**
+    A lazy view of carrier user information.
+
+    The view keeps the native user information, and decodes each
+    field only when it is accessed. Use `materialize()` to get a
+    `CarrierUserInfo` for long-term storage.
+
+    The native information is copied into the view on creation and never
+    changed, so a view may be read from any thread.
+ */
+@objc(ELACarrierUserInfoView)
+public class CarrierUserInfoView: NSObject {
+
+    private let cinfo: UnsafeMutablePointer<CUserInfo>
+    private var materialized: CarrierUserInfo?
+
+    internal init(_ cinfo: CUserInfo) {
+        self.cinfo = UnsafeMutablePointer<CUserInfo>.allocate(capacity: 1)
+        self.cinfo.initialize(to: cinfo)
+        super.init()
+    }
+
+    deinit {
+        cinfo.deinitialize()
+        cinfo.deallocate(capacity: 1)
+    }
+
+    /// User ID.
+    public var userId: String? {
+        return String(cCharPointer: &cinfo.pointee.userid)
+    }
+
+    /// Nickname, also known as display name.
+    public var name: String? {
+        return String(cCharPointer: &cinfo.pointee.name)
+    }
+
+    /// User's brief description, also known as what's up.
+    public var briefDescription: String? {
+        return String(cCharPointer: &cinfo.pointee.description)
+    }
+
+    /// Whether user has an avatar.
+    public var hasAvatar: Bool {
+        return cinfo.pointee.has_avatar != 0
+    }
+
+    /// User's gender.
+    public var gender: String? {
+        return String(cCharPointer: &cinfo.pointee.gender)
+    }
+
+    /// User's phone number.
+    public var phone: String? {
+        return String(cCharPointer: &cinfo.pointee.phone)
+    }
+
+    /// User's email address.
+    public var email: String? {
+        return String(cCharPointer: &cinfo.pointee.email)
+    }
+
+    /// User's region information.
+    public var region: String? {
+        return String(cCharPointer: &cinfo.pointee.region)
+    }
+
+    /// Decode all fields into user information. The result is decoded
+    /// once and shared by later calls.
+    ///
+    /// - Returns: The user information
+    public func materialize() -> CarrierUserInfo {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        if materialized == nil {
+            materialized = convertCUserInfoToCarrierUserInfo(cinfo.pointee)
+        }
+        return materialized!
+    }
+
+    public override var description: String {
+        return materialize().description
+    }
+}
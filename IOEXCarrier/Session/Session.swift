@@ -54,14 +54,11 @@ func onStateChanged(_: OpaquePointer?, cstream: Int32, cstate: UInt32,
                     cctxt: UnsafeMutableRawPointer?) {
 
     let stream  = getCurrentStream(cctxt!)
-
-    guard let handler = stream.delegate else {
-        return
-    }
-
     let state = CarrierStreamState(rawValue: Int(cstate))!
 
-    handler.streamStateDidChange?(stream, state)
+    stream.notifyDelegate { (handler) in
+        handler.streamStateDidChange?(stream, state)
+    }
 }
 
 func onStreamData(_: OpaquePointer?, cstream: Int32,
@@ -70,14 +67,16 @@ func onStreamData(_: OpaquePointer?, cstream: Int32,
 
     let stream  = getCurrentStream(cctxt!)
 
-    guard let handler = stream.delegate else {
+    guard stream.delegate != nil else {
         return
     }
 
     autoreleasepool {
         let data = Data(bytes: cdata!, count: clen)
 
-        handler.didReceiveStreamData?(stream, data)
+        stream.notifyDelegate { (handler) in
+            handler.didReceiveStreamData?(stream, data)
+        }
     }
 }
 
@@ -103,11 +102,9 @@ func onChannelOpened(_: OpaquePointer?, cstream:Int32,
 
     let stream  = getCurrentStream(cctxt!)
 
-    guard let handler = stream.delegate else {
-        return
+    stream.notifyDelegate { (handler) in
+        handler.didOpenNewChannel?(stream, Int(cchannel))
     }
-
-    handler.didOpenNewChannel?(stream, Int(cchannel))
 }
 
 func onChannelClose(_: OpaquePointer?, cstream:Int32,
@@ -115,14 +112,11 @@ func onChannelClose(_: OpaquePointer?, cstream:Int32,
                     cctxt: UnsafeMutableRawPointer?)
 {
     let stream  = getCurrentStream(cctxt!)
-
-    guard let handler = stream.delegate else {
-        return
-    }
-
     let reason = CloseReason(rawValue: Int(creason))!
 
-    handler.didCloseChannel?(stream, Int(cchannel), reason)
+    stream.notifyDelegate { (handler) in
+        handler.didCloseChannel?(stream, Int(cchannel), reason)
+    }
 }
 
 func onChannelData(_ : OpaquePointer?, cstream:Int32,
@@ -153,11 +147,9 @@ func onChannelPending(_ : OpaquePointer?, cstream:Int32,
 {
     let stream  = getCurrentStream(cctxt!)
 
-    guard let handler = stream.delegate else {
-        return
+    stream.notifyDelegate { (handler) in
+        handler.channelPending?(stream, Int(cchannel))
     }
-
-    handler.channelPending?(stream, Int(cchannel))
 }
 
 func onChannelResume(_ : OpaquePointer?, cstream:Int32,
@@ -165,11 +157,9 @@ func onChannelResume(_ : OpaquePointer?, cstream:Int32,
 {
     let stream  = getCurrentStream(cctxt!)
 
-    guard let handler = stream.delegate else {
-        return
+    stream.notifyDelegate { (handler) in
+        handler.channelResumed?(stream, Int(cchannel))
     }
-
-    handler.channelResumed?(stream, Int(cchannel))
 }
 
 @inline(__always) private func TAG() -> String { return "CarrierSession" }
@@ -182,12 +172,14 @@ public typealias CarrierSessionRequestCompleteHandler = (_ session: CarrierSessi
 public class CarrierSession: NSObject {
 
     internal var csession: OpaquePointer
+    internal weak var carrier: Carrier?
     private  var streams : Dictionary<Int, CarrierStream>
     private  var to: String
     private  var didClose: Bool
 
-    internal init(_ csession: OpaquePointer, _ to: String) {
+    internal init(_ csession: OpaquePointer, _ to: String, _ carrier: Carrier?) {
         self.csession = csession
+        self.carrier = carrier
         self.streams  = [Int: CarrierStream]()
         self.to = to
         self.didClose = false
@@ -205,6 +197,7 @@ public class CarrierSession: NSObject {
             Log.d(TAG(), "Begin to close native session instance ...")
 
             IOEX_session_close(csession)
+            RequestTable.shared.removeAll(ownedBy: self)
             didClose = true
 
             Log.d(TAG(), "Native session instance closed nicely")
@@ -223,21 +216,29 @@ public class CarrierSession: NSObject {
 
     /// Send session request to the friend.
     ///
+    /// The handler is invoked on the `delegateQueue` of carrier node, or on
+    /// the event loop thread if no delegate queue is set.
+    ///
     /// - Parameters:
     ///   - handler: A handler to receive the session response
     ///
+    /// - Returns: The pending request, which can be cancelled before the
+    ///            response arrives
+    ///
     /// - Throws: CarrierError
+    @discardableResult
     @objc(sendInviteRequestWithResponseHandler:error:)
-    public func sendInviteRequest(handler: @escaping CarrierSessionRequestCompleteHandler) throws {
+    public func sendInviteRequest(handler: @escaping CarrierSessionRequestCompleteHandler) throws -> CarrierRequest {
 
         let cb: CSessionRequestCompleteCallback = {
                 (_, cstatus, creason, csdp, clen, cctxt) in
 
-                let wctxt = Unmanaged<AnyObject>.fromOpaque(cctxt!)
-                    .takeRetainedValue() as! [AnyObject?]
+                guard let request = RequestTable.shared.take(RequestTable.id(cctxt!)) else {
+                    return
+                }
 
-                let session = wctxt[0] as! CarrierSession
-                let handler = wctxt[1] as! CarrierSessionRequestCompleteHandler
+                let session = request.owner as! CarrierSession
+                let handler = request.handler as! CarrierSessionRequestCompleteHandler
 
                 let status = Int(cstatus)
                 var reason: String?
@@ -249,24 +250,34 @@ public class CarrierSession: NSObject {
                     sdp = String(cString: csdp!)
                 }
 
-                handler(session, status, reason, sdp)
+                guard let carrier = session.carrier else {
+                    handler(session, status, reason, sdp)
+                    return
+                }
+
+                carrier.dispatchToDelegateQueue {
+                    handler(session, status, reason, sdp)
+                }
         }
 
         Log.d(TAG(), "Begin to request to invite session to \(to) ...")
 
-        let wcontext : [AnyObject?] = [self, handler as AnyObject]
-        let manager = Unmanaged.passRetained(wcontext as AnyObject);
-        let cctxt = manager.toOpaque()
-        let result = IOEX_session_request(csession, cb, cctxt)
+        guard let id = RequestTable.shared.add(self, handler) else {
+            Log.e(TAG(), "Request to invite session error: too many pending requests")
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_LIMIT_EXCEEDED))
+        }
+
+        let result = IOEX_session_request(csession, cb, RequestTable.context(id))
 
         guard result >= 0 else {
-            manager.release()
+            RequestTable.shared.remove(id)
             let errno = getErrorCode()
             Log.e(TAG(), "Request to invite session error: 0x%X", errno)
             throw CarrierError.InternalError(errno: errno)
         }
 
         Log.d(TAG(), "Sended session invite request to \(to)")
+        return CarrierRequest(id)
     }
 
     /// Reply the session request from friend.
@@ -387,6 +398,7 @@ public class CarrierSession: NSObject {
 
         let stream = CarrierStream(self.csession, type)
         stream.delegate = delegate
+        stream.carrier = carrier
 
         Log.d(TAG(), "Begin to add a new stream with type \(type)")
 
@@ -54,9 +54,10 @@ public typealias CarrierSessionRequestHandler = (_ carrier: Carrier,
 @objc(ELACarrierSessionManager)
 public class CarrierSessionManager: NSObject {
 
-    private static var sessionMgr: CarrierSessionManager?
+    private static var sessionMgrs = [OpaquePointer: CarrierSessionManager]()
 
     private var carrier: Carrier?
+    private var cnode: OpaquePointer?
     private var handler: CarrierSessionRequestHandler?
     private var didCleanup: Bool
 
@@ -76,10 +77,16 @@ public class CarrierSessionManager: NSObject {
     public static func getInstance(carrier: Carrier)
         throws -> CarrierSessionManager {
 
-        if (sessionMgr != nil && sessionMgr!.carrier != carrier) {
-            sessionMgr!.cleanup()
+        guard let cnode = carrier.cnode else {
+            throw CarrierError.InvalidArgument
         }
 
+        objc_sync_enter(CarrierSessionManager.self)
+        defer {
+            objc_sync_exit(CarrierSessionManager.self)
+        }
+
+        var sessionMgr = sessionMgrs[cnode]
         if (sessionMgr == nil) {
             Log.d(TAG(), "Begin to initialize native carrier session manager...")
 
@@ -95,6 +102,7 @@ public class CarrierSessionManager: NSObject {
 
             sessionMgr = CarrierSessionManager(carrier)
             sessionMgr!.didCleanup = false
+            sessionMgrs[cnode] = sessionMgr
 
             Log.i(TAG(), "Native carrier session manager instance created.");
         }
@@ -118,10 +126,16 @@ public class CarrierSessionManager: NSObject {
                                    handler: @escaping CarrierSessionRequestHandler)
         throws -> CarrierSessionManager {
 
-        if (sessionMgr != nil && sessionMgr!.carrier != carrier) {
-            sessionMgr!.cleanup()
+        guard let cnode = carrier.cnode else {
+            throw CarrierError.InvalidArgument
         }
 
+        objc_sync_enter(CarrierSessionManager.self)
+        defer {
+            objc_sync_exit(CarrierSessionManager.self)
+        }
+
+        var sessionMgr = sessionMgrs[cnode]
         if (sessionMgr == nil) {
 
             Log.d(TAG(), "Begin to initialize native carrier session manager...")
@@ -130,13 +144,15 @@ public class CarrierSessionManager: NSObject {
                 let manager = Unmanaged<CarrierSessionManager>
                         .fromOpaque(cctxt!).takeUnretainedValue()
 
-                let carrier = manager.carrier
-                let handler = manager.handler
+                let carrier = manager.carrier!
+                let handler = manager.handler!
 
                 let from = String(cString: cfrom!)
                 let  sdp = String(cString: csdp!)
 
-                handler!(carrier!, from, sdp)
+                carrier.dispatchToDelegateQueue {
+                    handler(carrier, from, sdp)
+                }
 
             }
 
@@ -157,6 +173,7 @@ public class CarrierSessionManager: NSObject {
 
             sessionManager.didCleanup = false
             sessionMgr = sessionManager
+            sessionMgrs[cnode] = sessionManager
 
             Log.i(TAG(), "Native carrier session manager instance created.");
         }
@@ -164,15 +181,40 @@ public class CarrierSessionManager: NSObject {
         return sessionMgr!;
     }
 
-    /// Get a carrier session manager instance.
+    /// Get the carrier session manager instance of the default carrier
+    /// node.
     ///
     /// - Returns: The carrier session manager or nil
     public static func getInstance() -> CarrierSessionManager? {
-        return sessionMgr;
+        guard let carrier = Carrier.getInstance() else {
+            return nil
+        }
+
+        return getInstance(of: carrier)
+    }
+
+    /// Get the carrier session manager instance of the specified carrier
+    /// node.
+    ///
+    /// - Parameter carrier: Carrier node instance
+    ///
+    /// - Returns: The carrier session manager or nil
+    public static func getInstance(of carrier: Carrier) -> CarrierSessionManager? {
+        guard let cnode = carrier.cnode else {
+            return nil
+        }
+
+        objc_sync_enter(CarrierSessionManager.self)
+        defer {
+            objc_sync_exit(CarrierSessionManager.self)
+        }
+
+        return sessionMgrs[cnode]
     }
 
     private init(_ carrier: Carrier) {
         self.carrier = carrier
+        self.cnode = carrier.cnode
         self.didCleanup = true
     }
 
@@ -189,7 +231,11 @@ public class CarrierSessionManager: NSObject {
 
             IOEX_session_cleanup(carrier!.ccarrier)
             carrier = nil
-            CarrierSessionManager.sessionMgr = nil
+
+            objc_sync_enter(CarrierSessionManager.self)
+            CarrierSessionManager.sessionMgrs.removeValue(forKey: cnode!)
+            objc_sync_exit(CarrierSessionManager.self)
+
             didCleanup = true
 
             Log.i(TAG(), "Native carrier session managed cleanuped.")
@@ -222,6 +268,6 @@ public class CarrierSessionManager: NSObject {
 
         Log.i(TAG(), "An new session to \(target) created locally.")
 
-        return CarrierSession(ctmp!, target)
+        return CarrierSession(ctmp!, target, carrier)
     }
 }
@@ -56,6 +56,7 @@ public class CarrierStream: NSObject {
     private var      type: CarrierStreamType;
 
     internal weak var delegate: CarrierStreamDelegate?
+    internal weak var carrier: Carrier?
 
     internal init(_ csession: OpaquePointer, _ type: CarrierStreamType) {
         self.csession = csession
@@ -73,6 +74,23 @@ public class CarrierStream: NSObject {
         }
     }
 
+    /// Invoke the delegate on the delegate queue of carrier node, or on the
+    /// event loop thread if no delegate queue is set.
+    internal func notifyDelegate(_ event: @escaping (CarrierStreamDelegate) -> Void) {
+        guard let carrier = carrier else {
+            if let handler = delegate {
+                event(handler)
+            }
+            return
+        }
+
+        carrier.dispatchToDelegateQueue {
+            if let handler = self.delegate {
+                event(handler)
+            }
+        }
+    }
+
     /// Get the carrier stream type.
     ///
     /// - Returns: The stream type defined in CarrierStreamType
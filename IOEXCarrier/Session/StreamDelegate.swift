@@ -48,7 +48,10 @@ import Foundation
 /// The protocol to carrier stream instance.
 ///
 /// Include stream status callback, stream data callback, and channel 
-/// callbacks.
+/// callbacks. They are invoked on the `delegateQueue` of carrier node if
+/// set, except `shouldOpenNewChannel` and `didReceiveChannelData`, which
+/// return their result to the native node and so are always invoked on
+/// the event loop thread.
 @objc(ELACarrierStreamDelegate)
 public protocol CarrierStreamDelegate {
 
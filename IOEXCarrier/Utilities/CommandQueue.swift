@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+private final class CommandNode {
+    let command: () -> Void
+    var next: UnsafeMutableRawPointer?
+
+    init(_ command: @escaping () -> Void) {
+        self.command = command
+    }
+}
+
+/// A lock-free multiple-producer/single-consumer command queue.
+///
+/// Producers push commands onto an atomic linked stack with one compare
+/// and swap. The single consumer detaches the whole stack at once and
+/// runs the commands in submission order, so pushing never waits on the
+/// consumer or on other producers holding a lock.
+///
+/// Once the consumer closes the queue, the top is swapped to a sentinel
+/// in the same way, and pushes fail instead of leaving commands behind
+/// that would never run.
+internal final class CommandQueue {
+
+    private static let CLOSED = UnsafeMutableRawPointer(bitPattern: 1)!
+
+    private let top: UnsafeMutablePointer<UnsafeMutableRawPointer?>
+
+    internal init() {
+        top = UnsafeMutablePointer<UnsafeMutableRawPointer?>.allocate(capacity: 1)
+        top.initialize(to: nil)
+    }
+
+    deinit {
+        _ = detach()
+        top.deallocate(capacity: 1)
+    }
+
+    /// Push a command, can be called from any thread.
+    ///
+    /// - Returns: Whether the command was queued, false if the queue is
+    ///            closed
+    @discardableResult
+    internal func push(_ command: @escaping () -> Void) -> Bool {
+        let node = CommandNode(command)
+        let ptr = Unmanaged.passRetained(node).toOpaque()
+
+        repeat {
+            node.next = top.pointee
+            if node.next == CommandQueue.CLOSED {
+                Unmanaged<CommandNode>.fromOpaque(ptr).release()
+                return false
+            }
+        } while !OSAtomicCompareAndSwapPtrBarrier(node.next, ptr, top)
+
+        return true
+    }
+
+    /// Run all pending commands, called from the consumer thread only.
+    ///
+    /// - Returns: The number of commands executed
+    @discardableResult
+    internal func drain() -> Int {
+        let commands = detach()
+
+        for command in commands {
+            command()
+        }
+        return commands.count
+    }
+
+    /// Close the queue and run the commands still pending, called from
+    /// the consumer thread only.
+    internal func close() {
+        for command in detach(closing: true) {
+            command()
+        }
+    }
+
+    private func detach(closing: Bool = false) -> [() -> Void] {
+        var ptr: UnsafeMutableRawPointer?
+
+        repeat {
+            ptr = top.pointee
+            if ptr == CommandQueue.CLOSED || (ptr == nil && !closing) {
+                return []
+            }
+        } while !OSAtomicCompareAndSwapPtrBarrier(ptr, closing ? CommandQueue.CLOSED : nil, top)
+
+        var commands = [() -> Void]()
+        while ptr != nil {
+            let node = Unmanaged<CommandNode>.fromOpaque(ptr!).takeRetainedValue()
+            commands.append(node.command)
+            ptr = node.next
+        }
+
+        return commands.reversed()
+    }
+}
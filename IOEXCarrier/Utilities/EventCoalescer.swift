@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// Merges friend connection status and presence events over a window,
+/// keeping only the net final state per friend.
+///
+/// Events are added and flushed on the event loop thread only. The
+/// coalesced counter can be read from any thread.
+internal final class EventCoalescer {
+
+    private final class Pending {
+        let friendId: String
+        let handle: Int
+        var oldStatus: CarrierConnectionStatus?
+        var oldPresence: CarrierPresenceStatus?
+        var status: CarrierConnectionStatus?
+        var presence: CarrierPresenceStatus?
+
+        init(_ friendId: String, _ handle: Int) {
+            self.friendId = friendId
+            self.handle = handle
+        }
+    }
+
+    internal let window: TimeInterval
+
+    private var pending: [String: Pending]
+    private var order: [Pending]
+    private let coalescedEvents: UnsafeMutablePointer<Int64>
+
+    internal init(window: TimeInterval) {
+        self.window = window
+        self.pending = [String: Pending]()
+        self.order = [Pending]()
+        self.coalescedEvents = UnsafeMutablePointer<Int64>.allocate(capacity: 1)
+        self.coalescedEvents.initialize(to: 0)
+    }
+
+    deinit {
+        coalescedEvents.deallocate(capacity: 1)
+    }
+
+    /// The number of events merged away since carrier node started.
+    internal var coalesced: Int64 {
+        return OSAtomicAdd64Barrier(0, coalescedEvents)
+    }
+
+    /// Whether there are no pending events.
+    internal var isEmpty: Bool {
+        return order.isEmpty
+    }
+
+    internal func add(_ friendId: String, _ handle: Int,
+                      oldStatus: CarrierConnectionStatus?,
+                      status: CarrierConnectionStatus) {
+        let entry = find(friendId, handle)
+
+        if entry.status != nil {
+            OSAtomicIncrement64Barrier(coalescedEvents)
+        } else {
+            entry.oldStatus = oldStatus
+        }
+        entry.status = status
+    }
+
+    internal func add(_ friendId: String, _ handle: Int,
+                      oldPresence: CarrierPresenceStatus?,
+                      presence: CarrierPresenceStatus) {
+        let entry = find(friendId, handle)
+
+        if entry.presence != nil {
+            OSAtomicIncrement64Barrier(coalescedEvents)
+        } else {
+            entry.oldPresence = oldPresence
+        }
+        entry.presence = presence
+    }
+
+    /// Take the net changes of all pending friends. Friends ending the
+    /// window in their original state are dropped and counted as
+    /// coalesced.
+    ///
+    /// - Parameters:
+    ///   - status: The current status of friend, for friends with presence
+    ///             events only
+    ///   - presence: The current presence of friend, for friends with status
+    ///               events only
+    ///
+    /// - Returns: The net changes in order of first event
+    internal func flush(status: (String) -> CarrierConnectionStatus?,
+                        presence: (String) -> CarrierPresenceStatus?) -> [CarrierFriendStateChange] {
+        var changes = [CarrierFriendStateChange]()
+
+        for entry in order {
+            let statusChanged = entry.status != nil && entry.status != entry.oldStatus
+            let presenceChanged = entry.presence != nil && entry.presence != entry.oldPresence
+
+            guard statusChanged || presenceChanged else {
+                OSAtomicIncrement64Barrier(coalescedEvents)
+                continue
+            }
+
+            let finalStatus = entry.status ?? status(entry.friendId) ?? .Disconnected
+            let finalPresence = entry.presence ?? presence(entry.friendId) ?? .None
+
+            changes.append(CarrierFriendStateChange(entry.friendId, entry.handle,
+                                                    finalStatus, statusChanged,
+                                                    finalPresence, presenceChanged))
+        }
+
+        pending.removeAll()
+        order.removeAll()
+
+        return changes
+    }
+
+    private func find(_ friendId: String, _ handle: Int) -> Pending {
+        if let entry = pending[friendId] {
+            return entry
+        }
+
+        let entry = Pending(friendId, handle)
+        pending[friendId] = entry
+        order.append(entry)
+        return entry
+    }
+}
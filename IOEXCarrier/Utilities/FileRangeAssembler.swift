@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A file request held back until it is known whether it belongs to a
+/// multi-range file.
+internal struct FileRangeRequest {
+    internal let fileId: String
+    internal let friendId: String
+    internal let filename: String
+    internal let filesize: Int
+}
+
+/// A file received from a friend as several concurrent range transfers.
+internal final class FileRangeTransfer {
+
+    internal let transferId: Int
+    internal let friendId: String
+    internal let filename: String
+    internal let rangeCount: Int
+    internal var filesize: Int64 = 0
+
+    /// The file ids of the ranges in range order, once listed by the sender.
+    internal var fileIds = [String]()
+    internal var requested = Set<String>()
+    internal var held = [FileRangeRequest]()
+
+    internal var fullpath: String?
+    internal var partPaths = [String]()
+    internal var starts = [Int64]()
+    internal var lengths = [Int64]()
+    internal var transferred = [Int64]()
+    internal var done = [Bool]()
+    internal var copied: Int = 0
+    internal var failed: Bool = false
+    internal var progress: ((_ transferred: Int64, _ size: Int64) -> Void)?
+    internal var completion: ((_ fullpath: String?, _ error: Error?) -> Void)?
+
+    internal init(_ transferId: Int, _ friendId: String, _ filename: String,
+                  _ rangeCount: Int) {
+        self.transferId = transferId
+        self.friendId = friendId
+        self.filename = filename
+        self.rangeCount = rangeCount
+    }
+
+    internal var isListed: Bool {
+        return !fileIds.isEmpty
+    }
+
+    internal var isReady: Bool {
+        return isListed && requested.count == rangeCount
+    }
+
+    internal var isAccepted: Bool {
+        return fullpath != nil
+    }
+
+    internal var totalTransferred: Int64 {
+        var total: Int64 = 0
+        for index in 0..<transferred.count {
+            total += max(0, min(transferred[index] - starts[index], lengths[index]))
+        }
+        return total
+    }
+
+    /// Split the file into ranges of equal length, the last range taking
+    /// the remainder.
+    internal func split() {
+        let length = filesize / Int64(rangeCount)
+
+        for index in 0..<rangeCount {
+            let start = length * Int64(index)
+            starts.append(start)
+            lengths.append(index < rangeCount - 1 ? length : filesize - start)
+            transferred.append(start)
+            done.append(false)
+        }
+    }
+}
+
+/// Groups the range transfers of files sent with multi-range requests,
+/// and assembles the received ranges into their destination files.
+///
+/// The sender announces a multi-range file with a frame carrying
+/// magic(1) type(1) rangeCount(2) and the file name, sends one file
+/// request per range, and then lists the file ids of the ranges in range
+/// order with a frame carrying magic(1) type(1) count(2), a length(1)
+/// prefixed id per range, and the file name. File requests of that name
+/// from the friend are held back from the announce until the list, which
+/// tells which of them are ranges. Others, and all held requests of files
+/// whose list does not arrive in `EXPECT_TIMEOUT`, are reported as plain
+/// file requests.
+///
+/// Seeking a transfer resumes it at an absolute position: the native node
+/// writes the bytes from the range start at the same offset of the part
+/// file, and reports progress as an absolute offset too. Each range is
+/// accepted into its own part file after seeking to the range start. Once
+/// a range has reached its end its transfer is cancelled, and the range
+/// is copied into place in the preallocated destination file on a
+/// background queue.
+internal final class FileRangeAssembler {
+
+    internal static let MAX_RANGES: Int = 16
+
+    /// How long the range requests of an announced file are waited for,
+    /// in seconds.
+    internal static let EXPECT_TIMEOUT: TimeInterval = 30
+
+    private static let COPY_CHUNK: Int = 1024 * 1024
+
+    private var nextTransferId: Int = 0
+    private var expected: [String: FileRangeTransfer]
+    private var transfers: [Int: FileRangeTransfer]
+    private var ranges: [String: (transfer: FileRangeTransfer, index: Int)]
+    private var retired: Set<String>
+
+    internal init() {
+        expected = [String: FileRangeTransfer]()
+        transfers = [Int: FileRangeTransfer]()
+        ranges = [String: (transfer: FileRangeTransfer, index: Int)]()
+        retired = Set<String>()
+    }
+
+    internal static func announce(_ filename: String, _ rangeCount: Int) -> Data {
+        var frame = Data(capacity: 4 + filename.utf8.count)
+        frame.append(FrameHeader.MAGIC)
+        frame.append(FrameHeader.TYPE_FILE_RANGES)
+        FrameHeader.write16(&frame, UInt16(rangeCount))
+        frame.append(contentsOf: Array(filename.utf8))
+        return frame
+    }
+
+    internal static func list(_ filename: String, _ fileIds: [String]) -> Data {
+        var length = 4 + filename.utf8.count
+        for fileId in fileIds {
+            length += 1 + fileId.utf8.count
+        }
+
+        var frame = Data(capacity: length)
+        frame.append(FrameHeader.MAGIC)
+        frame.append(FrameHeader.TYPE_FILE_RANGE_IDS)
+        FrameHeader.write16(&frame, UInt16(fileIds.count))
+        for fileId in fileIds {
+            frame.append(UInt8(fileId.utf8.count))
+            frame.append(contentsOf: Array(fileId.utf8))
+        }
+        frame.append(contentsOf: Array(filename.utf8))
+        return frame
+    }
+
+    /// Expect the range requests of a file announced by a friend.
+    ///
+    /// - Returns: The transfer expected, to be expired by the caller after
+    ///            `EXPECT_TIMEOUT`
+    internal func didReceiveAnnounce(_ friendId: String,
+                                     _ bytes: UnsafeRawBufferPointer) -> FileRangeTransfer? {
+        guard bytes.count > 4 else {
+            return nil
+        }
+
+        let rangeCount = Int(FrameHeader.read16(bytes, 2))
+        let nameBytes = UnsafeRawBufferPointer(start: bytes.baseAddress! + 4,
+                                               count: bytes.count - 4)
+        guard rangeCount > 0 && rangeCount <= FileRangeAssembler.MAX_RANGES,
+            let filename = String(bytes: nameBytes, encoding: .utf8) else {
+            return nil
+        }
+
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        nextTransferId += 1
+        let transfer = FileRangeTransfer(nextTransferId, friendId, filename, rangeCount)
+        expected[friendId + "/" + filename] = transfer
+        return transfer
+    }
+
+    /// Collect a file request into the transfer of its file.
+    ///
+    /// - Returns: Whether the request belongs, or may belong, to a
+    ///            multi-range file, and the transfer once all its range
+    ///            requests arrived
+    internal func didReceiveRequest(_ request: FileRangeRequest)
+        -> (handled: Bool, ready: FileRangeTransfer?) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        if let range = ranges[request.fileId] {
+            range.transfer.filesize = Int64(request.filesize)
+            range.transfer.requested.insert(request.fileId)
+            return (true, takeReady(range.transfer))
+        }
+
+        guard let transfer = expected[request.friendId + "/" + request.filename],
+            !transfer.isListed else {
+            return (false, nil)
+        }
+
+        transfer.held.append(request)
+        return (true, nil)
+    }
+
+    /// Match the held requests of an announced file against the file ids
+    /// listed by the sender.
+    ///
+    /// - Returns: The transfer if all its range requests arrived, and the
+    ///            held requests that are not ranges of it
+    internal func didReceiveList(_ friendId: String, _ bytes: UnsafeRawBufferPointer)
+        -> (ready: FileRangeTransfer?, released: [FileRangeRequest]) {
+        guard bytes.count > 4 else {
+            return (nil, [])
+        }
+
+        let count = Int(FrameHeader.read16(bytes, 2))
+        var fileIds = [String]()
+        var offset = 4
+
+        while fileIds.count < count && offset < bytes.count {
+            let length = Int(bytes[offset])
+            offset += 1
+            guard length > 0 && offset + length <= bytes.count,
+                let fileId = String(bytes: UnsafeRawBufferPointer(start: bytes.baseAddress! + offset,
+                                                                  count: length),
+                                    encoding: .utf8) else {
+                return (nil, [])
+            }
+            fileIds.append(fileId)
+            offset += length
+        }
+
+        guard fileIds.count == count && Set(fileIds).count == count && offset < bytes.count,
+            let filename = String(bytes: UnsafeRawBufferPointer(start: bytes.baseAddress! + offset,
+                                                                count: bytes.count - offset),
+                                  encoding: .utf8) else {
+            return (nil, [])
+        }
+
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let transfer = expected[friendId + "/" + filename], !transfer.isListed,
+            count == transfer.rangeCount else {
+            return (nil, [])
+        }
+
+        transfer.fileIds = fileIds
+        for (index, fileId) in fileIds.enumerated() {
+            ranges[fileId] = (transfer, index)
+        }
+
+        var released = [FileRangeRequest]()
+        for request in transfer.held {
+            if ranges[request.fileId]?.transfer === transfer {
+                transfer.filesize = Int64(request.filesize)
+                transfer.requested.insert(request.fileId)
+            } else {
+                released.append(request)
+            }
+        }
+        transfer.held.removeAll()
+
+        return (takeReady(transfer), released)
+    }
+
+    /// Give up on an announced file whose range requests did not all
+    /// arrive in time.
+    ///
+    /// - Returns: The held requests, to be reported as plain requests, and
+    ///            the file ids of range requests already received
+    internal func expire(_ transfer: FileRangeTransfer)
+        -> (released: [FileRangeRequest], requested: [String]) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard transfers[transfer.transferId] !== transfer else {
+            return ([], [])
+        }
+
+        let key = transfer.friendId + "/" + transfer.filename
+        if expected[key] === transfer {
+            expected[key] = nil
+        }
+
+        for fileId in transfer.fileIds where ranges[fileId]?.transfer === transfer {
+            ranges[fileId] = nil
+        }
+
+        let released = transfer.held
+        transfer.held.removeAll()
+
+        return (released, transfer.fileIds.filter { transfer.requested.contains($0) })
+    }
+
+    private func takeReady(_ transfer: FileRangeTransfer) -> FileRangeTransfer? {
+        guard transfer.isReady else {
+            return nil
+        }
+
+        let key = transfer.friendId + "/" + transfer.filename
+        if expected[key] === transfer {
+            expected[key] = nil
+        }
+        transfers[transfer.transferId] = transfer
+        return transfer
+    }
+
+    internal func transfer(_ transferId: Int) -> FileRangeTransfer? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return transfers[transferId]
+    }
+
+    /// Preallocate the destination and prepare the ranges of a transfer.
+    ///
+    /// - Throws: CarrierError
+    internal func accept(_ transfer: FileRangeTransfer, _ filepath: String,
+                         _ filename: String,
+                         _ progress: ((Int64, Int64) -> Void)?,
+                         _ completion: @escaping (String?, Error?) -> Void) throws {
+        let fullpath = (filepath as NSString).appendingPathComponent(filename)
+
+        guard FileManager.default.createFile(atPath: fullpath, contents: nil, attributes: nil),
+            let handle = FileHandle(forWritingAtPath: fullpath) else {
+            throw CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+        }
+        handle.truncateFile(atOffset: UInt64(transfer.filesize))
+        handle.closeFile()
+
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        transfer.split()
+        for index in 0..<transfer.rangeCount {
+            transfer.partPaths.append("\(fullpath).range\(index)")
+        }
+        transfer.progress = progress
+        transfer.completion = completion
+        transfer.fullpath = fullpath
+    }
+
+    /// Record the progress of a range, as the absolute offset reached in
+    /// the file.
+    ///
+    /// - Returns: Whether the file belongs to a multi-range file, and the
+    ///            transfer if the range has just reached its end
+    internal func didProgress(_ fileId: String, _ transferred: Int64)
+        -> (handled: Bool, received: FileRangeTransfer?) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let range = ranges[fileId] else {
+            return (retired.contains(fileId), nil)
+        }
+
+        let transfer = range.transfer
+        let index = range.index
+
+        guard transfer.isAccepted && !transfer.done[index] && !transfer.failed else {
+            return (true, nil)
+        }
+
+        transfer.transferred[index] = transferred
+        transfer.progress?(transfer.totalTransferred, transfer.filesize)
+
+        // The last range runs to the end of file, and completes natively.
+        guard transferred >= transfer.starts[index] + transfer.lengths[index] &&
+            index < transfer.rangeCount - 1 else {
+            return (true, nil)
+        }
+
+        transfer.done[index] = true
+        return (true, transfer)
+    }
+
+    /// Record the native completion of a range.
+    ///
+    /// - Returns: Whether the file belongs to a multi-range file, and the
+    ///            transfer if the range has just been received
+    internal func didComplete(_ fileId: String) -> (handled: Bool, received: FileRangeTransfer?) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let range = ranges[fileId] else {
+            return (retired.remove(fileId) != nil, nil)
+        }
+
+        let transfer = range.transfer
+        let index = range.index
+
+        guard transfer.isAccepted && !transfer.done[index] && !transfer.failed else {
+            return (true, nil)
+        }
+
+        transfer.transferred[index] = transfer.starts[index] + transfer.lengths[index]
+        transfer.done[index] = true
+        return (true, transfer)
+    }
+
+    /// Record the failure of a range, failing the whole transfer.
+    ///
+    /// - Returns: Whether the file belongs to a multi-range file, and the
+    ///            transfer if it has just failed
+    internal func didFail(_ fileId: String) -> (handled: Bool, failed: FileRangeTransfer?) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let range = ranges[fileId] else {
+            return (retired.remove(fileId) != nil, nil)
+        }
+
+        let transfer = range.transfer
+        let index = range.index
+
+        // Ranges cancelled after being received report their cancel too.
+        guard !transfer.failed && !(transfer.isAccepted && transfer.done[index]) else {
+            return (true, nil)
+        }
+
+        transfer.failed = true
+        return (true, transfer)
+    }
+
+    /// Take the completion handler of a transfer, to invoke it once.
+    internal func takeCompletion(_ transfer: FileRangeTransfer) -> ((String?, Error?) -> Void)? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        let completion = transfer.completion
+        transfer.completion = nil
+        return completion
+    }
+
+    /// Copy a received range into place, and finish the transfer once all
+    /// ranges are copied.
+    ///
+    /// - Parameters:
+    ///   - transfer: The transfer of the range
+    ///   - index: The index of the range
+    ///   - copied: The handler invoked after the range was copied, before
+    ///             its part file is removed
+    internal func copy(_ transfer: FileRangeTransfer, _ index: Int,
+                       copied: (() -> Void)? = nil) {
+        DispatchQueue.global(qos: .utility).async {
+            let error = FileRangeAssembler.copy(transfer.partPaths[index], transfer.fullpath!,
+                                                transfer.starts[index], transfer.lengths[index])
+            copied?()
+            try? FileManager.default.removeItem(atPath: transfer.partPaths[index])
+
+            objc_sync_enter(self)
+            transfer.copied += 1
+            let finished = error != nil || transfer.copied == transfer.rangeCount
+            let completion = transfer.failed ? nil : transfer.completion
+            if finished {
+                transfer.failed = transfer.failed || error != nil
+                transfer.completion = nil
+            }
+            objc_sync_exit(self)
+
+            if finished {
+                self.remove(transfer)
+                completion?(error == nil ? transfer.fullpath : nil, error)
+            }
+        }
+    }
+
+    /// Drop a transfer and its part files.
+    internal func remove(_ transfer: FileRangeTransfer) {
+        objc_sync_enter(self)
+        transfers[transfer.transferId] = nil
+        for fileId in transfer.fileIds where ranges[fileId] != nil {
+            ranges[fileId] = nil
+            retired.insert(fileId)
+        }
+        transfer.progress = nil
+        transfer.completion = nil
+        objc_sync_exit(self)
+
+        for path in transfer.partPaths {
+            try? FileManager.default.removeItem(atPath: path)
+        }
+    }
+
+    private static func copy(_ partPath: String, _ fullpath: String,
+                             _ start: Int64, _ length: Int64) -> Error? {
+        guard length > 0 else {
+            return nil
+        }
+
+        guard let part = FileHandle(forReadingAtPath: partPath),
+            let destination = FileHandle(forWritingAtPath: fullpath) else {
+            return CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+        }
+        defer {
+            part.closeFile()
+            destination.closeFile()
+        }
+
+        part.seek(toFileOffset: UInt64(start))
+        destination.seek(toFileOffset: UInt64(start))
+
+        var remaining = length
+        while remaining > 0 {
+            let chunk = part.readData(ofLength: Int(min(remaining, Int64(COPY_CHUNK))))
+            guard !chunk.isEmpty else {
+                return CarrierError.InternalError(errno: IOEX_GENERAL_ERROR(IOEXERR_WRONG_STATE))
+            }
+
+            destination.write(chunk)
+            remaining -= Int64(chunk.count)
+        }
+        return nil
+    }
+}
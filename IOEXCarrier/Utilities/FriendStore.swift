@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// The in-memory friend store of carrier node, kept up to date by the
+/// native friend callbacks.
+///
+/// Each change bumps the store revision and is appended to a change log,
+/// so changes since a revision are found by walking the log backward
+/// without scanning all friends. Secondary indexes on connection status
+/// and presence let queries run in time proportional to the result.
+/// Friends updated from native callbacks are kept as lazy views and only
+/// decoded when their information is read. The stored friend information
+/// objects are never mutated once handed out.
+internal final class FriendStore {
+
+    private static let MAX_TOMBSTONES: Int = 1024
+
+    private final class Record {
+        var view: CarrierFriendInfoView?
+        var materialized: CarrierFriendInfo?
+        var revision: UInt64
+
+        init(_ revision: UInt64) {
+            self.revision = revision
+        }
+
+        var exists: Bool {
+            return view != nil || materialized != nil
+        }
+
+        var info: CarrierFriendInfo? {
+            if materialized == nil {
+                materialized = view?.materialize()
+            }
+            return materialized
+        }
+
+        var status: CarrierConnectionStatus {
+            return view?.status ?? materialized!.status
+        }
+
+        var presence: CarrierPresenceStatus {
+            return view?.presence ?? materialized!.presence
+        }
+
+        func set(_ info: CarrierFriendInfo?, _ view: CarrierFriendInfoView?) {
+            self.materialized = info
+            self.view = view
+        }
+    }
+
+    private var records: [String: Record]
+    private var changeLog: [(id: String, revision: UInt64)]
+    private var tombstones: Int
+    private var compactedRevision: UInt64
+    private var byStatus: [CarrierConnectionStatus: Set<String>]
+    private var byPresence: [CarrierPresenceStatus: Set<String>]
+
+    internal private(set) var revision: UInt64
+
+    /// Whether the whole friend list has been loaded from native node.
+    internal private(set) var isLoaded: Bool
+
+    internal init() {
+        records = [String: Record]()
+        changeLog = [(id: String, revision: UInt64)]()
+        tombstones = 0
+        compactedRevision = 0
+        byStatus = [CarrierConnectionStatus: Set<String>]()
+        byPresence = [CarrierPresenceStatus: Set<String>]()
+        revision = 0
+        isLoaded = false
+    }
+
+    internal func markLoaded() {
+        objc_sync_enter(self)
+        isLoaded = true
+        objc_sync_exit(self)
+    }
+
+    internal func update(_ info: CarrierFriendInfo) {
+        guard let friendId = info.userId else {
+            return
+        }
+
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        put(friendId, info, nil)
+    }
+
+    internal func update(_ view: CarrierFriendInfoView) {
+        guard let friendId = view.userId else {
+            return
+        }
+
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        put(friendId, nil, view)
+    }
+
+    internal func updateStatus(_ friendId: String, _ status: CarrierConnectionStatus) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let record = records[friendId], record.exists,
+            record.status != status else {
+            return
+        }
+
+        if let view = record.view {
+            put(friendId, nil, view.updated(status: status))
+        } else {
+            let newInfo = FriendStore.copy(record.info!)
+            newInfo.status = status
+            put(friendId, newInfo, nil)
+        }
+    }
+
+    internal func updatePresence(_ friendId: String, _ presence: CarrierPresenceStatus) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let record = records[friendId], record.exists,
+            record.presence != presence else {
+            return
+        }
+
+        if let view = record.view {
+            put(friendId, nil, view.updated(presence: presence))
+        } else {
+            let newInfo = FriendStore.copy(record.info!)
+            newInfo.presence = presence
+            put(friendId, newInfo, nil)
+        }
+    }
+
+    internal func updateLabel(_ friendId: String, _ label: String) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let info = records[friendId]?.info, info.label != label else {
+            return
+        }
+
+        let newInfo = FriendStore.copy(info)
+        newInfo.label = label
+        put(friendId, newInfo, nil)
+    }
+
+    internal func remove(_ friendId: String) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let record = records[friendId], record.exists else {
+            return
+        }
+
+        unindex(friendId, record.status, record.presence)
+
+        revision += 1
+        record.set(nil, nil)
+        record.revision = revision
+        changeLog.append((friendId, revision))
+        tombstones += 1
+
+        compactIfNeeded()
+    }
+
+    internal func get(_ friendId: String) -> CarrierFriendInfo? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return records[friendId]?.info
+    }
+
+    internal func status(of friendId: String) -> CarrierConnectionStatus? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let record = records[friendId], record.exists else {
+            return nil
+        }
+        return record.status
+    }
+
+    internal func presence(of friendId: String) -> CarrierPresenceStatus? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let record = records[friendId], record.exists else {
+            return nil
+        }
+        return record.presence
+    }
+
+    internal func contains(_ friendId: String) -> Bool {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return records[friendId]?.exists ?? false
+    }
+
+    internal func friends(withStatus status: CarrierConnectionStatus) -> [CarrierFriendInfo] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return collect(byStatus[status])
+    }
+
+    internal func friends(withPresence presence: CarrierPresenceStatus) -> [CarrierFriendInfo] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return collect(byPresence[presence])
+    }
+
+    internal func friendIds(withStatus status: CarrierConnectionStatus) -> [String] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return Array(byStatus[status] ?? [])
+    }
+
+    internal func friendIds(withLabel label: String) -> [String] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        var friendIds = [String]()
+        for (friendId, record) in records where record.exists {
+            if record.info?.label == label {
+                friendIds.append(friendId)
+            }
+        }
+        return friendIds
+    }
+
+    private func collect(_ friendIds: Set<String>?) -> [CarrierFriendInfo] {
+        var friends = [CarrierFriendInfo]()
+
+        for friendId in friendIds ?? [] {
+            if let info = records[friendId]?.info {
+                friends.append(info)
+            }
+        }
+        return friends
+    }
+
+    private func index(_ friendId: String, _ status: CarrierConnectionStatus,
+                       _ presence: CarrierPresenceStatus) {
+        if byStatus[status]?.insert(friendId) == nil {
+            byStatus[status] = [friendId]
+        }
+        if byPresence[presence]?.insert(friendId) == nil {
+            byPresence[presence] = [friendId]
+        }
+    }
+
+    private func unindex(_ friendId: String, _ status: CarrierConnectionStatus,
+                         _ presence: CarrierPresenceStatus) {
+        byStatus[status]?.remove(friendId)
+        byPresence[presence]?.remove(friendId)
+    }
+
+    /// Get the friends changed and removed since the given revision.
+    internal func changes(since: UInt64) -> CarrierFriendChanges {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        var changed = [CarrierFriendInfo]()
+        var removed = [String]()
+
+        if since < compactedRevision {
+            for record in records.values {
+                if let info = record.info {
+                    changed.append(info)
+                }
+            }
+            return CarrierFriendChanges(revision, changed, removed, true)
+        }
+
+        var index = changeLog.count - 1
+        while index >= 0 && changeLog[index].revision > since {
+            let entry = changeLog[index]
+
+            // Only the latest change of each friend is reported.
+            if let record = records[entry.id], record.revision == entry.revision {
+                if let info = record.info {
+                    changed.append(info)
+                } else {
+                    removed.append(entry.id)
+                }
+            }
+            index -= 1
+        }
+
+        return CarrierFriendChanges(revision, changed.reversed(),
+                                    removed.reversed(), false)
+    }
+
+    private func put(_ friendId: String, _ info: CarrierFriendInfo?,
+                     _ view: CarrierFriendInfoView?) {
+        revision += 1
+
+        let record: Record
+        if let oldRecord = records[friendId] {
+            record = oldRecord
+            if record.exists {
+                unindex(friendId, record.status, record.presence)
+            } else {
+                tombstones -= 1
+            }
+            record.revision = revision
+        } else {
+            record = Record(revision)
+            records[friendId] = record
+        }
+        record.set(info, view)
+        index(friendId, record.status, record.presence)
+        changeLog.append((friendId, revision))
+
+        compactIfNeeded()
+    }
+
+    private func compactIfNeeded() {
+        var compactLog = changeLog.count > records.count * 2 + FriendStore.MAX_TOMBSTONES
+
+        if tombstones > FriendStore.MAX_TOMBSTONES {
+            for (friendId, record) in records where !record.exists {
+                records.removeValue(forKey: friendId)
+            }
+            tombstones = 0
+            compactedRevision = revision
+            compactLog = true
+        }
+
+        guard compactLog else {
+            return
+        }
+
+        changeLog = changeLog.filter {
+            $0.revision > compactedRevision && records[$0.id]?.revision == $0.revision
+        }
+    }
+
+    private static func copy(_ info: CarrierFriendInfo) -> CarrierFriendInfo {
+        let newInfo = CarrierFriendInfo()
+        newInfo.userInfo = info
+        newInfo.label = info.label
+        newInfo.status = info.status
+        newInfo.presence = info.presence
+        return newInfo
+    }
+}
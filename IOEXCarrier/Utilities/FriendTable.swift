@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// An interned table of friend ids, mapping each id to a stable integer
+/// handle for the life of carrier node.
+///
+/// Ids from native callbacks are looked up by hashing the C string in
+/// place, so a known friend costs no String allocation. The C string copy
+/// of each id is kept to pass to native functions without conversion.
+internal final class FriendTable {
+
+    private static let INITIAL_BUCKETS: Int = 64
+
+    private final class Entry {
+        let handle: Int
+        let id: String
+        let cid: UnsafeMutablePointer<Int8>
+        let hash: UInt32
+        var next: Entry?
+
+        init(_ handle: Int, _ id: String, _ cid: UnsafeMutablePointer<Int8>,
+             _ hash: UInt32) {
+            self.handle = handle
+            self.id = id
+            self.cid = cid
+            self.hash = hash
+        }
+    }
+
+    private var buckets: [Entry?]
+    private var entries: [Entry]
+
+    internal init() {
+        buckets = [Entry?](repeating: nil, count: FriendTable.INITIAL_BUCKETS)
+        entries = [Entry]()
+    }
+
+    deinit {
+        for entry in entries {
+            free(entry.cid)
+        }
+    }
+
+    /// Intern the id from a native callback.
+    ///
+    /// - Parameter cid: The friend id as C string
+    ///
+    /// - Returns: The handle and the interned id
+    internal func intern(_ cid: UnsafePointer<Int8>) -> (handle: Int, id: String) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        let hash = FriendTable.hash(cid)
+        if let entry = find(cid, hash) {
+            return (entry.handle, entry.id)
+        }
+
+        let entry = insert(String(cString: cid), strdup(cid), hash)
+        return (entry.handle, entry.id)
+    }
+
+    /// Intern the id from application.
+    ///
+    /// - Parameter id: The friend id
+    ///
+    /// - Returns: The handle
+    internal func intern(_ id: String) -> Int {
+        return id.withCString { (cid) -> Int in
+            return intern(cid).handle
+        }
+    }
+
+    /// Look up the handle of the id without interning it.
+    ///
+    /// - Parameter id: The friend id
+    ///
+    /// - Returns: The handle, or nil if the id was never interned
+    internal func handle(of id: String) -> Int? {
+        return id.withCString { (cid) -> Int? in
+            objc_sync_enter(self)
+            defer {
+                objc_sync_exit(self)
+            }
+
+            return find(cid, FriendTable.hash(cid))?.handle
+        }
+    }
+
+    internal func id(of handle: Int) -> String? {
+        return entry(of: handle)?.id
+    }
+
+    /// The C string of the id, valid for the life of the table.
+    internal func cid(of handle: Int) -> UnsafePointer<Int8>? {
+        guard let cid = entry(of: handle)?.cid else {
+            return nil
+        }
+        return UnsafePointer<Int8>(cid)
+    }
+
+    private func entry(of handle: Int) -> Entry? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard handle > 0 && handle <= entries.count else {
+            return nil
+        }
+        return entries[handle - 1]
+    }
+
+    private func find(_ cid: UnsafePointer<Int8>, _ hash: UInt32) -> Entry? {
+        var entry = buckets[Int(hash & UInt32(buckets.count - 1))]
+
+        while entry != nil {
+            if entry!.hash == hash && strcmp(entry!.cid, cid) == 0 {
+                return entry
+            }
+            entry = entry!.next
+        }
+        return nil
+    }
+
+    private func insert(_ id: String, _ cid: UnsafeMutablePointer<Int8>,
+                        _ hash: UInt32) -> Entry {
+        if entries.count >= buckets.count * 2 {
+            rehash(buckets.count * 2)
+        }
+
+        let entry = Entry(entries.count + 1, id, cid, hash)
+        let index = Int(hash & UInt32(buckets.count - 1))
+
+        entry.next = buckets[index]
+        buckets[index] = entry
+        entries.append(entry)
+
+        return entry
+    }
+
+    private func rehash(_ count: Int) {
+        buckets = [Entry?](repeating: nil, count: count)
+
+        for entry in entries {
+            let index = Int(entry.hash & UInt32(count - 1))
+            entry.next = buckets[index]
+            buckets[index] = entry
+        }
+    }
+
+    private static func hash(_ cid: UnsafePointer<Int8>) -> UInt32 {
+        var hash: UInt32 = 2166136261
+        var ptr = cid
+
+        while ptr.pointee != 0 {
+            hash = (hash ^ UInt32(UInt8(bitPattern: ptr.pointee))) &* 16777619
+            ptr += 1
+        }
+        return hash
+    }
+}
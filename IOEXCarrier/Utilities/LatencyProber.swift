@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A fixed-size histogram of round-trip times with log2 buckets.
+///
+/// Bucket 0 counts RTTs below 1 millisecond, and bucket `i` counts RTTs
+/// in [2^(i-1), 2^i) milliseconds. The last bucket has no upper bound.
+internal struct LatencyHistogram {
+
+    internal static let BUCKETS: Int = 16
+
+    internal private(set) var buckets = [Int](repeating: 0, count: LatencyHistogram.BUCKETS)
+    internal private(set) var count: Int = 0
+    internal private(set) var minMicros: UInt64 = UInt64.max
+    internal private(set) var maxMicros: UInt64 = 0
+    internal private(set) var sumMicros: UInt64 = 0
+
+    internal mutating func record(_ micros: UInt64) {
+        let millis = micros / 1000
+        var bucket = 0
+        if millis > 0 {
+            bucket = min(64 - millis.leadingZeroBitCount, LatencyHistogram.BUCKETS - 1)
+        }
+
+        buckets[bucket] += 1
+        count += 1
+        minMicros = min(minMicros, micros)
+        maxMicros = max(maxMicros, micros)
+        sumMicros = sumMicros &+ micros
+    }
+
+    /// The upper bound of the bucket holding the percentile, in
+    /// milliseconds, or 0 if nothing was recorded.
+    internal func percentile(_ p: Double) -> Int {
+        guard count > 0 else {
+            return 0
+        }
+
+        let rank = max(1, Int((Double(count) * p).rounded(.up)))
+        var seen = 0
+        for (bucket, bucketCount) in buckets.enumerated() {
+            seen += bucketCount
+            if seen >= rank {
+                return bucket < LatencyHistogram.BUCKETS - 1 ?
+                    1 << bucket : Int(maxMicros / 1000)
+            }
+        }
+        return Int(maxMicros / 1000)
+    }
+}
+
+/// Round-trip time probes to connected friends over friend messages.
+///
+/// A probe is a ping frame carrying magic(1) type(1) sequence(4) and the
+/// send time(8) of the prober in microseconds. The friend echoes it back
+/// as a pong frame, so the RTT is measured on the local clock only.
+///
+/// Nodes without framing support deliver frames to application as text,
+/// so only friends known to handle frames are probed: friends that sent
+/// a valid frame, and friends the application opted in.
+internal final class LatencyProber {
+
+    internal static let FRAME_LENGTH: Int = 14
+
+    private final class FriendProbes {
+        var histogram = LatencyHistogram()
+        var sent: Int = 0
+        var received: Int = 0
+    }
+
+    internal let interval: TimeInterval
+
+    private var sequence: UInt32 = 0
+    private var friends: [String: FriendProbes]
+    private var peers: Set<String>
+
+    internal init(interval: TimeInterval) {
+        self.interval = interval
+        self.friends = [String: FriendProbes]()
+        self.peers = Set<String>()
+    }
+
+    /// Mark the friend as able to handle ping frames.
+    internal func addPeer(_ friendId: String) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        peers.insert(friendId)
+    }
+
+    /// Select the friends to probe.
+    internal func peers(of friendIds: [String]) -> [String] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return friendIds.filter { peers.contains($0) }
+    }
+
+    /// Build the ping frame of a new probe to the friend.
+    internal func ping(_ friendId: String) -> Data {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        sequence = sequence &+ 1
+        find(friendId).sent += 1
+
+        var frame = Data(capacity: LatencyProber.FRAME_LENGTH)
+        frame.append(FrameHeader.MAGIC)
+        frame.append(FrameHeader.TYPE_PING)
+        FrameHeader.write32(&frame, sequence)
+        let now = LatencyProber.nowMicros()
+        FrameHeader.write32(&frame, UInt32(truncatingIfNeeded: now >> 32))
+        FrameHeader.write32(&frame, UInt32(truncatingIfNeeded: now))
+        return frame
+    }
+
+    /// Build the pong frame echoing a received ping.
+    ///
+    /// - Returns: The pong frame, or nil if the ping is malformed
+    internal static func pong(_ ping: UnsafeRawBufferPointer) -> Data? {
+        guard ping.count == LatencyProber.FRAME_LENGTH else {
+            return nil
+        }
+
+        var frame = Data(bytes: ping.baseAddress!, count: ping.count)
+        frame[1] = FrameHeader.TYPE_PONG
+        return frame
+    }
+
+    /// Record the RTT of a received pong.
+    ///
+    /// - Returns: The RTT in microseconds, or nil if the pong is malformed
+    @discardableResult
+    internal func didReceivePong(_ friendId: String, _ pong: UnsafeRawBufferPointer) -> UInt64? {
+        guard pong.count == LatencyProber.FRAME_LENGTH else {
+            return nil
+        }
+
+        let sentAt = UInt64(FrameHeader.read32(pong, 6)) << 32 |
+            UInt64(FrameHeader.read32(pong, 10))
+        let now = LatencyProber.nowMicros()
+        guard sentAt <= now else {
+            return nil
+        }
+
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        let probes = find(friendId)
+        probes.received += 1
+        probes.histogram.record(now - sentAt)
+        return now - sentAt
+    }
+
+    internal func stats(_ friendId: String) -> CarrierLatencyStats? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let probes = friends[friendId] else {
+            return nil
+        }
+        return CarrierLatencyStats(friendId, probes.histogram, probes.sent, probes.received)
+    }
+
+    internal func stats() -> [CarrierLatencyStats] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        var stats = [CarrierLatencyStats]()
+        for (friendId, probes) in friends {
+            stats.append(CarrierLatencyStats(friendId, probes.histogram,
+                                             probes.sent, probes.received))
+        }
+        return stats
+    }
+
+    private func find(_ friendId: String) -> FriendProbes {
+        if let probes = friends[friendId] {
+            return probes
+        }
+
+        let probes = FriendProbes()
+        friends[friendId] = probes
+        return probes
+    }
+
+    private static func nowMicros() -> UInt64 {
+        return DispatchTime.now().uptimeNanoseconds / 1000
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// Packs small messages queued to the same friend within a short delay
+/// into one friend message, Nagle style.
+///
+/// A batch is sent when adding a message would exceed the byte
+/// threshold, or when the delay since its first message expires. Used on
+/// the event loop thread only.
+internal final class MessageBatcher {
+
+    private static let TAG: String = "MessageBatcher"
+
+    private final class Batch {
+        var records = [Data]()
+        var completions = [Carrier.CarrierCommandCompletionHandler?]()
+        var length: Int = MessageBatch.HEADER_LEN
+        var timer: CarrierTimer?
+    }
+
+    internal let maxDelay: TimeInterval
+    internal let maxBytes: Int
+
+    private weak var carrier: Carrier?
+    private var batches: [String: Batch]
+
+    internal init(_ carrier: Carrier, maxDelay: TimeInterval, maxBytes: Int) {
+        self.carrier = carrier
+        self.maxDelay = maxDelay
+        self.maxBytes = maxBytes
+        self.batches = [String: Batch]()
+    }
+
+    internal func add(_ target: String, _ data: Data,
+                      _ completion: Carrier.CarrierCommandCompletionHandler?) {
+        let recordLength = MessageBatch.RECORD_HEADER_LEN + data.count
+
+        // Too large to batch, send on its own after the queued ones.
+        guard MessageBatch.HEADER_LEN + recordLength <= maxBytes else {
+            flush(target)
+            send(target, [data], [completion])
+            return
+        }
+
+        if let batch = batches[target], batch.length + recordLength > maxBytes {
+            flush(target)
+        }
+
+        let batch: Batch
+        if let pending = batches[target] {
+            batch = pending
+        } else {
+            batch = Batch()
+            batches[target] = batch
+        }
+
+        batch.records.append(data)
+        batch.completions.append(completion)
+        batch.length += recordLength
+
+        if batch.length + MessageBatch.RECORD_HEADER_LEN >= maxBytes {
+            flush(target)
+        } else if batch.timer == nil {
+            scheduleFlush(target, batch)
+        }
+    }
+
+    /// Flush the batch after the delay, or at once if no timer can be
+    /// scheduled, so the batch never waits for a later message.
+    private func scheduleFlush(_ target: String, _ batch: Batch) {
+        guard let carrier = carrier else {
+            flush(target)
+            return
+        }
+
+        weak var weakSelf = self
+        do {
+            batch.timer = try carrier.schedule(after: maxDelay) { _ in
+                weakSelf?.flush(target)
+            }
+        } catch {
+            Log.w(MessageBatcher.TAG, "Schedule batch flush to \(target) error: \(error)")
+            flush(target)
+        }
+    }
+
+    internal func flush(_ target: String) {
+        guard let batch = batches.removeValue(forKey: target) else {
+            return
+        }
+
+        batch.timer?.cancel()
+        send(target, batch.records, batch.completions)
+    }
+
+    /// Fail all pending messages, when carrier node stops.
+    internal func cancelAll(_ error: Error) {
+        for batch in batches.values {
+            batch.timer?.cancel()
+            for completion in batch.completions {
+                carrier?.complete(completion, error)
+            }
+        }
+        batches.removeAll()
+    }
+
+    private func send(_ target: String, _ records: [Data],
+                      _ completions: [Carrier.CarrierCommandCompletionHandler?]) {
+        guard let carrier = carrier else {
+            return
+        }
+
+        var error: Error? = nil
+        if records.count > 1 {
+            do {
+                try carrier.sendFrame(to: target, MessageBatch.pack(records))
+            } catch let sendError {
+                error = sendError
+            }
+        } else {
+            error = carrier.sendMessage(to: target, records[0])
+        }
+
+        for completion in completions {
+            carrier.complete(completion, error)
+        }
+    }
+}
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// The frame header carried by fragmented friend messages.
+///
+/// All framed messages start with magic(1) type(1). The magic byte 0xFA
+/// never starts a valid UTF-8 text, so framed messages are told apart
+/// from plain text messages. Fragments then carry, in network byte order:
+///
+///     messageId(4) count(2) index(2) totalLength(4)
+internal struct FrameHeader {
+
+    internal static let MAGIC: UInt8 = 0xFA
+    internal static let LENGTH: Int = 14
+
+    internal static let TYPE_FRAGMENT: UInt8 = 0x01
+    internal static let TYPE_BATCH: UInt8 = 0x02
+    internal static let TYPE_PING: UInt8 = 0x03
+    internal static let TYPE_PONG: UInt8 = 0x04
+    internal static let TYPE_FILE_RANGES: UInt8 = 0x05
+    internal static let TYPE_FILE_RANGE_IDS: UInt8 = 0x06
+
+    /// The payload length of each fragment except the last one.
+    internal static let FRAGMENT_PAYLOAD_LEN: Int =
+        Carrier.MAX_APP_MESSAGE_LEN - FrameHeader.LENGTH
+
+    internal let type: UInt8
+    internal let messageId: UInt32
+    internal let count: Int
+    internal let index: Int
+    internal let totalLength: Int
+
+    internal init(type: UInt8, messageId: UInt32, count: Int, index: Int,
+                  totalLength: Int) {
+        self.type = type
+        self.messageId = messageId
+        self.count = count
+        self.index = index
+        self.totalLength = totalLength
+    }
+
+    /// Get the frame type of a received message.
+    ///
+    /// - Returns: The frame type, or nil if the message is not framed
+    internal static func type(of bytes: UnsafeRawBufferPointer) -> UInt8? {
+        guard bytes.count >= 2 && bytes[0] == FrameHeader.MAGIC else {
+            return nil
+        }
+        return bytes[1]
+    }
+
+    /// Whether a message must be framed to be told apart from frames.
+    internal static func needsFraming(_ data: Data) -> Bool {
+        return data.first == FrameHeader.MAGIC
+    }
+
+    /// Parse the header of a received fragment.
+    ///
+    /// - Returns: The header, or nil if the message is not a fragment
+    internal init?(_ bytes: UnsafeRawBufferPointer) {
+        guard bytes.count >= FrameHeader.LENGTH && bytes[0] == FrameHeader.MAGIC &&
+            bytes[1] == FrameHeader.TYPE_FRAGMENT else {
+            return nil
+        }
+
+        type = bytes[1]
+        messageId = FrameHeader.read32(bytes, 2)
+        count = Int(FrameHeader.read16(bytes, 6))
+        index = Int(FrameHeader.read16(bytes, 8))
+        totalLength = Int(FrameHeader.read32(bytes, 10))
+
+        guard count > 0 && index < count else {
+            return nil
+        }
+    }
+
+    internal func append(to data: inout Data) {
+        data.append(FrameHeader.MAGIC)
+        data.append(type)
+        FrameHeader.write32(&data, messageId)
+        FrameHeader.write16(&data, UInt16(count))
+        FrameHeader.write16(&data, UInt16(index))
+        FrameHeader.write32(&data, UInt32(totalLength))
+    }
+
+    /// Split a message into framed fragments.
+    ///
+    /// - Returns: The fragments, or nil if the message is too long
+    internal static func fragments(of data: Data, messageId: UInt32) -> [Data]? {
+        let count = max(1, (data.count + FRAGMENT_PAYLOAD_LEN - 1) / FRAGMENT_PAYLOAD_LEN)
+        guard count <= Int(UInt16.max) else {
+            return nil
+        }
+
+        var fragments = [Data]()
+        fragments.reserveCapacity(count)
+
+        for index in 0..<count {
+            let start = data.startIndex + index * FRAGMENT_PAYLOAD_LEN
+            let end = min(start + FRAGMENT_PAYLOAD_LEN, data.endIndex)
+
+            var fragment = Data(capacity: FrameHeader.LENGTH + end - start)
+            FrameHeader(type: TYPE_FRAGMENT, messageId: messageId, count: count,
+                        index: index, totalLength: data.count).append(to: &fragment)
+            fragment.append(data[start..<end])
+            fragments.append(fragment)
+        }
+
+        return fragments
+    }
+
+    internal static func read16(_ bytes: UnsafeRawBufferPointer, _ offset: Int) -> UInt16 {
+        return UInt16(bytes[offset]) << 8 | UInt16(bytes[offset + 1])
+    }
+
+    internal static func read32(_ bytes: UnsafeRawBufferPointer, _ offset: Int) -> UInt32 {
+        return UInt32(read16(bytes, offset)) << 16 | UInt32(read16(bytes, offset + 2))
+    }
+
+    internal static func write16(_ data: inout Data, _ value: UInt16) {
+        data.append(UInt8(value >> 8))
+        data.append(UInt8(value & 0xFF))
+    }
+
+    internal static func write32(_ data: inout Data, _ value: UInt32) {
+        write16(&data, UInt16(value >> 16))
+        write16(&data, UInt16(value & 0xFFFF))
+    }
+}
+
+/// A batch of small friend messages packed into one message.
+///
+/// Layout, in network byte order:
+///
+///     magic(1) type(1) [length(2) payload(length)]...
+internal struct MessageBatch {
+
+    internal static let HEADER_LEN: Int = 2
+    internal static let RECORD_HEADER_LEN: Int = 2
+
+    internal static func pack(_ records: [Data]) -> Data {
+        var length = HEADER_LEN
+        for record in records {
+            length += RECORD_HEADER_LEN + record.count
+        }
+
+        var data = Data(capacity: length)
+        data.append(FrameHeader.MAGIC)
+        data.append(FrameHeader.TYPE_BATCH)
+
+        for record in records {
+            FrameHeader.write16(&data, UInt16(record.count))
+            data.append(record)
+        }
+        return data
+    }
+
+    /// Unpack a received batch.
+    ///
+    /// - Returns: The messages in the batch, pointing into the received
+    ///            bytes, or nil if the batch is malformed
+    internal static func unpack(_ bytes: UnsafeRawBufferPointer) -> [UnsafeRawBufferPointer]? {
+        guard let base = bytes.baseAddress else {
+            return nil
+        }
+
+        var records = [UnsafeRawBufferPointer]()
+        var offset = HEADER_LEN
+
+        while offset < bytes.count {
+            guard offset + RECORD_HEADER_LEN <= bytes.count else {
+                return nil
+            }
+
+            let length = Int(FrameHeader.read16(bytes, offset))
+            offset += RECORD_HEADER_LEN
+
+            guard length > 0 && offset + length <= bytes.count else {
+                return nil
+            }
+
+            records.append(UnsafeRawBufferPointer(start: base + offset, count: length))
+            offset += length
+        }
+        return records
+    }
+}
+
+/// Reassembles fragmented friend messages, with bounded memory per
+/// friend.
+///
+/// Fragments may arrive in any order. Each message is reassembled in
+/// place into one buffer of its total length. When a new message would
+/// exceed the memory limit of a friend, the oldest partial messages of
+/// that friend are dropped. Used on the event loop thread only.
+internal final class MessageReassembler {
+
+    private static let TIMEOUT: UInt64 = 30_000
+
+    private final class Partial {
+        let messageId: UInt32
+        let count: Int
+        var buffer: Data
+        var received: [Bool]
+        var remaining: Int
+        let started: UInt64
+
+        init(_ header: FrameHeader) {
+            messageId = header.messageId
+            count = header.count
+            buffer = Data(count: header.totalLength)
+            received = [Bool](repeating: false, count: header.count)
+            remaining = header.count
+            started = TimerWheel.monotonicMilliseconds()
+        }
+    }
+
+    /// The maximum bytes of partial messages kept per friend.
+    internal var limit: Int
+
+    private var partials: [Int: [Partial]]
+    private var bytes: [Int: Int]
+
+    internal init(limit: Int) {
+        self.limit = limit
+        self.partials = [Int: [Partial]]()
+        self.bytes = [Int: Int]()
+    }
+
+    /// Add a received fragment.
+    ///
+    /// - Parameters:
+    ///   - handle: The handle of friend who sent the fragment
+    ///   - header: The frame header of the fragment
+    ///   - payload: The payload of the fragment
+    ///
+    /// - Returns: The full message once all its fragments arrived
+    internal func add(_ handle: Int, _ header: FrameHeader,
+                      _ payload: UnsafeRawBufferPointer) -> Data? {
+        let offset = header.index * FrameHeader.FRAGMENT_PAYLOAD_LEN
+        let expected = header.index < header.count - 1 ?
+            FrameHeader.FRAGMENT_PAYLOAD_LEN : header.totalLength - offset
+
+        let count = max(1, (header.totalLength + FrameHeader.FRAGMENT_PAYLOAD_LEN - 1) /
+                           FrameHeader.FRAGMENT_PAYLOAD_LEN)
+
+        guard header.totalLength <= limit && header.count == count &&
+            payload.count == expected else {
+            return nil
+        }
+
+        if header.count == 1 {
+            return Data(payload)
+        }
+
+        guard let partial = find(handle, header) else {
+            return nil
+        }
+
+        guard !partial.received[header.index] else {
+            return nil
+        }
+
+        if let base = payload.baseAddress, payload.count > 0 {
+            partial.buffer.withUnsafeMutableBytes { (ptr: UnsafeMutablePointer<UInt8>) in
+                (ptr + offset).assign(from: base.assumingMemoryBound(to: UInt8.self),
+                                      count: payload.count)
+            }
+        }
+        partial.received[header.index] = true
+        partial.remaining -= 1
+
+        guard partial.remaining == 0 else {
+            return nil
+        }
+
+        drop(handle, partial)
+        return partial.buffer
+    }
+
+    /// Drop all partial messages of the friend.
+    internal func remove(_ handle: Int) {
+        partials.removeValue(forKey: handle)
+        bytes.removeValue(forKey: handle)
+    }
+
+    private func find(_ handle: Int, _ header: FrameHeader) -> Partial? {
+        var list = partials[handle] ?? []
+        let now = TimerWheel.monotonicMilliseconds()
+
+        if let partial = list.first(where: { $0.messageId == header.messageId }) {
+            return partial.count == header.count &&
+                partial.buffer.count == header.totalLength ? partial : nil
+        }
+
+        var used = bytes[handle] ?? 0
+        while let oldest = list.first,
+            used + header.totalLength > limit ||
+                now - oldest.started > MessageReassembler.TIMEOUT {
+            used -= oldest.buffer.count
+            list.removeFirst()
+        }
+
+        let partial = Partial(header)
+        list.append(partial)
+
+        partials[handle] = list
+        bytes[handle] = used + header.totalLength
+
+        return partial
+    }
+
+    private func drop(_ handle: Int, _ partial: Partial) {
+        guard var list = partials[handle],
+            let index = list.index(where: { $0 === partial }) else {
+            return
+        }
+
+        list.remove(at: index)
+        partials[handle] = list
+        bytes[handle] = (bytes[handle] ?? 0) - partial.buffer.count
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// One message being sent to many friends on the loop thread.
+///
+/// The message is framed once, and the friend ids are interned once into
+/// C strings, so each recipient costs only the native sends.
+internal final class MulticastSend {
+
+    internal typealias Recipient = (handle: Int, id: String, cid: UnsafePointer<Int8>)
+
+    internal let frames: [Data]
+    internal let recipients: [Recipient]
+    internal var next: Int = 0
+    internal var sent = [String]()
+    internal var failed: [String: Int]
+
+    /// - Parameters:
+    ///   - frames: The frames of the message
+    ///   - recipients: The friends to send to
+    ///   - failed: The targets already failed before sending, with their
+    ///             error codes
+    internal init(_ frames: [Data], _ recipients: [Recipient],
+                  failed: [String: Int] = [:]) {
+        self.frames = frames
+        self.recipients = recipients
+        self.failed = failed
+        sent.reserveCapacity(recipients.count)
+    }
+
+    internal var isDone: Bool {
+        return next >= recipients.count
+    }
+
+    /// Send to the next recipients, at most `count` of them.
+    ///
+    /// - Parameters:
+    ///   - count: The most recipients to send to
+    ///   - send: The native send of one frame, returning the error code
+    ///           or 0 on success
+    internal func send(_ count: Int,
+                       _ send: (Recipient, Data) -> Int) {
+        let end = min(next + count, recipients.count)
+
+        for index in next..<end {
+            let recipient = recipients[index]
+            var errno = 0
+
+            for frame in frames {
+                errno = send(recipient, frame)
+                if errno != 0 {
+                    break
+                }
+            }
+
+            if errno == 0 {
+                sent.append(recipient.id)
+            } else {
+                failed[recipient.id] = errno
+            }
+        }
+        next = end
+    }
+
+    /// Fail all recipients not sent to yet.
+    internal func cancel(_ errno: Int) {
+        for index in next..<recipients.count {
+            failed[recipients[index].id] = errno
+        }
+        next = recipients.count
+    }
+
+    internal func result() -> CarrierMulticastResult {
+        return CarrierMulticastResult(sent, failed)
+    }
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// Bounded per-friend queues of outbound friend messages, persisted
+/// under the persistent location of carrier node.
+///
+/// Messages can be queued from any thread, and are sent in order on the
+/// event loop thread while the friend is online. Each friend queue is
+/// saved to its own file named by the friend id, so queued messages
+/// survive restarts of carrier node. Only valid ids may be queued to.
+///
+/// Saving takes a snapshot of the changed queues under the lock, and
+/// writes the files on a background queue, so neither the event loop nor
+/// the producers wait on the disk.
+internal final class OutboundQueue {
+
+    private static let TAG: String = "OutboundQueue"
+    private static let DIRECTORY: String = "outbound"
+
+    private final class FriendQueue {
+        var messages = [Data]()
+        var aboveHigh = false
+        var dirty = false
+    }
+
+    internal let capacity: Int
+    internal let highWatermark: Int
+    internal let lowWatermark: Int
+
+    private let directory: String?
+    private var queues: [String: FriendQueue]
+    private let writer: DispatchQueue
+
+    internal init(_ persistentLocation: String?, capacity: Int,
+                  highWatermark: Int, lowWatermark: Int) {
+        self.capacity = capacity
+        self.highWatermark = highWatermark
+        self.lowWatermark = lowWatermark
+        self.directory = persistentLocation.map {
+            ($0 as NSString).appendingPathComponent(OutboundQueue.DIRECTORY)
+        }
+        self.queues = [String: FriendQueue]()
+        self.writer = DispatchQueue(label: "org.elastos.outbound", qos: .utility)
+        load()
+    }
+
+    /// Queue a message to the friend.
+    ///
+    /// - Returns: Whether the message was accepted, and whether the queue
+    ///            just rose to the high watermark
+    internal func push(_ friendId: String, _ data: Data) -> (accepted: Bool, high: Bool) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        let queue = find(friendId)
+        guard queue.messages.count < capacity else {
+            return (false, false)
+        }
+
+        queue.messages.append(data)
+        queue.dirty = true
+
+        if !queue.aboveHigh && queue.messages.count >= highWatermark {
+            queue.aboveHigh = true
+            return (true, true)
+        }
+        return (true, false)
+    }
+
+    internal func peek(_ friendId: String) -> Data? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return queues[friendId]?.messages.first
+    }
+
+    /// Remove the head message of the friend after it was sent.
+    ///
+    /// - Returns: Whether the queue just drained to the low watermark
+    internal func pop(_ friendId: String) -> Bool {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let queue = queues[friendId], !queue.messages.isEmpty else {
+            return false
+        }
+
+        queue.messages.removeFirst()
+        queue.dirty = true
+
+        if queue.aboveHigh && queue.messages.count <= lowWatermark {
+            queue.aboveHigh = false
+            return true
+        }
+        return false
+    }
+
+    internal func depth(_ friendId: String) -> Int {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return queues[friendId]?.messages.count ?? 0
+    }
+
+    internal func depths() -> [String: Int] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        var depths = [String: Int]()
+        for (friendId, queue) in queues where !queue.messages.isEmpty {
+            depths[friendId] = queue.messages.count
+        }
+        return depths
+    }
+
+    /// Get the friends whose queues are at or above the high watermark.
+    internal func friendIdsAboveHighWatermark() -> [String] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return queues.filter { $0.value.aboveHigh }.map { $0.key }
+    }
+
+    internal func friendIds() -> [String] {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return Array(queues.keys)
+    }
+
+    /// Save the changed friend queues to their files asynchronously.
+    internal func save() {
+        guard let directory = directory else {
+            return
+        }
+
+        var snapshots = [(String, [Data])]()
+
+        objc_sync_enter(self)
+        for (friendId, queue) in queues where queue.dirty {
+            snapshots.append((friendId, queue.messages))
+            queue.dirty = false
+        }
+        objc_sync_exit(self)
+
+        guard !snapshots.isEmpty else {
+            return
+        }
+
+        writer.async {
+            for (friendId, messages) in snapshots {
+                if !self.write(directory, friendId, messages) {
+                    self.markDirty(friendId)
+                }
+            }
+        }
+    }
+
+    /// Save the changed friend queues, and wait until all pending saves
+    /// are written.
+    internal func flush() {
+        save()
+        writer.sync {}
+    }
+
+    private func write(_ directory: String, _ friendId: String, _ messages: [Data]) -> Bool {
+        let path = (directory as NSString).appendingPathComponent(friendId + ".plist")
+
+        do {
+            if messages.isEmpty {
+                if FileManager.default.fileExists(atPath: path) {
+                    try FileManager.default.removeItem(atPath: path)
+                }
+            } else {
+                try FileManager.default.createDirectory(atPath: directory,
+                                                        withIntermediateDirectories: true,
+                                                        attributes: nil)
+                let data = try PropertyListSerialization.data(fromPropertyList: messages,
+                                                              format: .binary,
+                                                              options: 0)
+                try data.write(to: URL(fileURLWithPath: path), options: .atomic)
+            }
+            return true
+        } catch {
+            Log.w(OutboundQueue.TAG, "Save outbound queue of \(friendId) error: \(error)")
+            return false
+        }
+    }
+
+    /// Have a queue whose save failed saved again next time.
+    private func markDirty(_ friendId: String) {
+        objc_sync_enter(self)
+        queues[friendId]?.dirty = true
+        objc_sync_exit(self)
+    }
+
+    private func load() {
+        guard let directory = directory,
+            let files = try? FileManager.default.contentsOfDirectory(atPath: directory) else {
+            return
+        }
+
+        for file in files where file.hasSuffix(".plist") {
+            let path = (directory as NSString).appendingPathComponent(file)
+            let friendId = (file as NSString).deletingPathExtension
+
+            guard Carrier.isValidId(friendId),
+                let data = FileManager.default.contents(atPath: path),
+                let plist = try? PropertyListSerialization.propertyList(from: data,
+                                                                        options: [],
+                                                                        format: nil),
+                let messages = plist as? [Data] else {
+                continue
+            }
+
+            let queue = FriendQueue()
+            queue.messages = Array(messages.prefix(capacity))
+            queue.aboveHigh = queue.messages.count >= highWatermark
+            queues[friendId] = queue
+        }
+    }
+
+    private func find(_ friendId: String) -> FriendQueue {
+        if let queue = queues[friendId] {
+            return queue
+        }
+
+        let queue = FriendQueue()
+        queues[friendId] = queue
+        return queue
+    }
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A pooled table of pending native requests, keyed by request id.
+///
+/// The request id is passed to native functions as the callback context
+/// instead of a retained box, so cancelling a request frees its slot at
+/// once. A response arriving later for a freed or reused slot carries a
+/// stale generation and is dropped. Slots are preallocated and reused, and
+/// a request can carry a timer that expires it when no response arrives.
+///
+/// The generation takes 15 bits above the 16 index bits, so request ids
+/// stay positive in a 32-bit Int.
+internal final class RequestTable {
+
+    internal static let shared = RequestTable()
+
+    private static let INDEX_BITS: Int = 16
+    private static let INDEX_MASK: Int = (1 << INDEX_BITS) - 1
+    private static let GENERATION_MASK: Int = (1 << 15) - 1
+    private static let MAX_SLOTS: Int = INDEX_MASK
+    private static let PREALLOCATED_SLOTS: Int = 64
+
+    private final class Slot {
+        var generation: Int = 0
+        var owner: AnyObject?
+        var handler: Any?
+        var timer: CarrierTimer?
+    }
+
+    private var slots: [Slot]
+    private var freeSlots: [Int]
+    private var completed: Int = 0
+    private var timedOut: Int = 0
+    private var cancelled: Int = 0
+
+    private init() {
+        slots = [Slot]()
+        freeSlots = [Int]()
+
+        slots.reserveCapacity(RequestTable.PREALLOCATED_SLOTS)
+        for index in 0..<RequestTable.PREALLOCATED_SLOTS {
+            slots.append(Slot())
+            freeSlots.append(RequestTable.PREALLOCATED_SLOTS - 1 - index)
+        }
+    }
+
+    /// Add a pending request.
+    ///
+    /// - Parameters:
+    ///   - owner: The object to keep alive until the request completes
+    ///   - handler: The response handler of the request
+    ///
+    /// - Returns: The request id, or nil if the table is full
+    internal func add(_ owner: AnyObject, _ handler: Any) -> Int? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        let index: Int
+        if let free = freeSlots.popLast() {
+            index = free
+        } else if slots.count < RequestTable.MAX_SLOTS {
+            index = slots.count
+            slots.append(Slot())
+        } else {
+            return nil
+        }
+
+        let slot = slots[index]
+        slot.generation = (slot.generation + 1) & RequestTable.GENERATION_MASK
+        slot.owner = owner
+        slot.handler = handler
+
+        return (slot.generation << RequestTable.INDEX_BITS) | (index + 1)
+    }
+
+    /// Attach the timeout timer of a pending request. The timer is
+    /// cancelled at once if the request has already finished.
+    internal func setTimer(_ id: Int, _ timer: CarrierTimer) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let slot = find(id), slot.handler != nil else {
+            timer.cancel()
+            return
+        }
+
+        slot.timer = timer
+    }
+
+    /// Remove a pending request on its response and return its owner and
+    /// handler.
+    ///
+    /// - Parameter id: The request id
+    ///
+    /// - Returns: The owner and handler, or nil if the request has been
+    ///            completed, expired or cancelled
+    internal func take(_ id: Int) -> (owner: AnyObject, handler: Any)? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let request = free(id) else {
+            return nil
+        }
+
+        completed += 1
+        return request
+    }
+
+    /// Remove a pending request when its timeout expires.
+    internal func expire(_ id: Int) -> (owner: AnyObject, handler: Any)? {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        guard let request = free(id) else {
+            return nil
+        }
+
+        timedOut += 1
+        return request
+    }
+
+    /// Remove a pending request without invoking its handler, when it is
+    /// cancelled or failed to send.
+    internal func remove(_ id: Int) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        if free(id) != nil {
+            cancelled += 1
+        }
+    }
+
+    /// Remove all pending requests of the owner, when it goes away.
+    internal func removeAll(ownedBy owner: AnyObject) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        for (index, slot) in slots.enumerated() where slot.owner === owner {
+            slot.timer?.cancel()
+            slot.timer = nil
+            slot.owner = nil
+            slot.handler = nil
+            freeSlots.append(index)
+            cancelled += 1
+        }
+    }
+
+    internal func contains(_ id: Int) -> Bool {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return find(id)?.handler != nil
+    }
+
+    internal func stats() -> CarrierRequestStats {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        return CarrierRequestStats(inFlight: slots.count - freeSlots.count,
+                                   completed: completed, timedOut: timedOut,
+                                   cancelled: cancelled)
+    }
+
+    private func free(_ id: Int) -> (owner: AnyObject, handler: Any)? {
+        guard let slot = find(id), let owner = slot.owner,
+            let handler = slot.handler else {
+            return nil
+        }
+
+        slot.timer?.cancel()
+        slot.timer = nil
+        slot.owner = nil
+        slot.handler = nil
+        freeSlots.append((id & RequestTable.INDEX_MASK) - 1)
+
+        return (owner, handler)
+    }
+
+    private func find(_ id: Int) -> Slot? {
+        let index = (id & RequestTable.INDEX_MASK) - 1
+        guard index >= 0 && index < slots.count else {
+            return nil
+        }
+
+        let slot = slots[index]
+        guard slot.generation == (id >> RequestTable.INDEX_BITS) else {
+            return nil
+        }
+
+        return slot
+    }
+
+    @inline(__always)
+    internal static func context(_ id: Int) -> UnsafeMutableRawPointer {
+        return UnsafeMutableRawPointer(bitPattern: id)!
+    }
+
+    @inline(__always)
+    internal static func id(_ context: UnsafeMutableRawPointer) -> Int {
+        return Int(bitPattern: context)
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A fixed capacity single-producer/single-consumer ring buffer.
+///
+/// Slots are preallocated on creation. The producer and the consumer each
+/// own one index and publish it with a memory barrier, so neither side
+/// takes a lock. Only one thread may push and only one thread may pop at
+/// the same time.
+internal final class RingBuffer<Element> {
+
+    internal let capacity: Int
+
+    private let mask: Int
+    private let slots: UnsafeMutablePointer<Element?>
+    private let head: UnsafeMutablePointer<Int>
+    private let tail: UnsafeMutablePointer<Int>
+    private let counters: UnsafeMutablePointer<Int64>
+
+    internal init(capacity: Int) {
+        var size = 1
+        while size < capacity {
+            size <<= 1
+        }
+
+        self.capacity = size
+        self.mask = size - 1
+
+        slots = UnsafeMutablePointer<Element?>.allocate(capacity: size)
+        slots.initialize(to: nil, count: size)
+        head = UnsafeMutablePointer<Int>.allocate(capacity: 1)
+        head.initialize(to: 0)
+        tail = UnsafeMutablePointer<Int>.allocate(capacity: 1)
+        tail.initialize(to: 0)
+
+        // [0]: dropped elements, [1]: high watermark
+        counters = UnsafeMutablePointer<Int64>.allocate(capacity: 2)
+        counters.initialize(to: 0, count: 2)
+    }
+
+    deinit {
+        slots.deinitialize(count: capacity)
+        slots.deallocate(capacity: capacity)
+        head.deallocate(capacity: 1)
+        tail.deallocate(capacity: 1)
+        counters.deallocate(capacity: 2)
+    }
+
+    /// Number of elements waiting to be popped.
+    internal var count: Int {
+        let t = tail.pointee
+        OSMemoryBarrier()
+        return t - head.pointee
+    }
+
+    /// Number of elements dropped because the ring was full.
+    internal var dropped: Int64 {
+        return OSAtomicAdd64Barrier(0, counters)
+    }
+
+    /// The maximum number of elements ever waiting in the ring.
+    internal var highWatermark: Int64 {
+        return OSAtomicAdd64Barrier(0, counters + 1)
+    }
+
+    /// Push an element, called from the producer thread only.
+    ///
+    /// - Returns: false if the ring is full and the element was dropped
+    internal func push(_ element: Element) -> Bool {
+        let t = tail.pointee
+        let h = head.pointee
+        OSMemoryBarrier()
+
+        let depth = t - h
+        guard depth < capacity else {
+            OSAtomicIncrement64Barrier(counters)
+            return false
+        }
+
+        slots[t & mask] = element
+        OSMemoryBarrier()
+        tail.pointee = t + 1
+
+        if Int64(depth + 1) > counters[1] {
+            counters[1] = Int64(depth + 1)
+        }
+        return true
+    }
+
+    /// Pop an element, called from the consumer thread only.
+    ///
+    /// - Returns: The oldest element or nil if the ring is empty
+    internal func pop() -> Element? {
+        let h = head.pointee
+        let t = tail.pointee
+        OSMemoryBarrier()
+
+        guard h != t else {
+            return nil
+        }
+
+        let element = slots[h & mask]
+        slots[h & mask] = nil
+        OSMemoryBarrier()
+        head.pointee = h + 1
+
+        return element
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// The text envelope of RPC calls and replies carried in friend invite
+/// data.
+///
+/// A call is `#rpc/1 <callId> <method>\n<params>`, and a reply, in the
+/// data or the reason of the invite response, is `#rpc/1 <callId>\n<body>`.
+/// Invite data without the prefix is left to the delegate.
+internal struct RpcEnvelope {
+
+    private static let PREFIX: String = "#rpc/1 "
+
+    internal let callId: Int
+    internal let method: String?
+    internal let body: String
+
+    internal static func call(_ callId: Int, _ method: String, _ params: String) -> String {
+        return "\(PREFIX)\(callId) \(method)\n\(params)"
+    }
+
+    internal static func reply(_ callId: Int, _ body: String) -> String {
+        return "\(PREFIX)\(callId)\n\(body)"
+    }
+
+    internal static func isValid(method: String) -> Bool {
+        return !method.isEmpty && method.rangeOfCharacter(from: .whitespacesAndNewlines) == nil
+    }
+
+    /// Parse an envelope.
+    ///
+    /// - Returns: The envelope, or nil if the text is not an RPC envelope
+    internal static func parse(_ text: String) -> RpcEnvelope? {
+        guard text.hasPrefix(PREFIX) else {
+            return nil
+        }
+
+        let rest = text[text.index(text.startIndex, offsetBy: PREFIX.count)...]
+        guard let newline = rest.index(of: "\n") else {
+            return nil
+        }
+
+        let header = rest[rest.startIndex..<newline].split(separator: " ",
+                                                          omittingEmptySubsequences: false)
+        guard header.count == 1 || header.count == 2,
+            let callId = Int(header[0]) else {
+            return nil
+        }
+
+        let method = header.count == 2 ? String(header[1]) : nil
+        return RpcEnvelope(callId: callId, method: method,
+                           body: String(rest[rest.index(after: newline)...]))
+    }
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// A hierarchical timing wheel with O(1) insert and cancel.
+///
+/// Four levels of 64 slots cover 2^24 ticks. Timers due within 64 ticks
+/// live in the lowest level, later timers sit in higher levels and
+/// cascade down as the wheel turns. Longer delays are clamped to the
+/// last tick, so callers must reject delays beyond `maxMilliseconds`.
+/// The wheel is only used from the carrier loop thread.
+internal final class TimerWheel {
+
+    private static let SLOT_BITS: UInt64 = 6
+    private static let SLOTS: Int = 64
+    private static let LEVELS: Int = 4
+    private static let MAX_TICKS: UInt64 = (1 << 24) - 1
+
+    internal let resolution: UInt64
+    private let origin: UInt64
+    private var current: UInt64
+    private var wheels: [[CarrierTimer]]
+    private(set) var count: Int
+
+    /// - Parameter resolution: The length of one tick, in milliseconds
+    internal init(resolution: UInt64) {
+        self.resolution = resolution
+        self.origin = TimerWheel.monotonicMilliseconds()
+        self.current = 0
+        self.count = 0
+
+        var wheels = [[CarrierTimer]]()
+        for _ in 0..<TimerWheel.LEVELS {
+            var slots = [CarrierTimer]()
+            for _ in 0..<TimerWheel.SLOTS {
+                let head = CarrierTimer(nil, 0, false, nil)
+                head.prev = head
+                head.next = head
+                slots.append(head)
+            }
+            wheels.append(slots)
+        }
+        self.wheels = wheels
+    }
+
+    deinit {
+        for slots in wheels {
+            for head in slots {
+                while head.next !== head {
+                    head.next!.unlink()
+                }
+                head.prev = nil
+                head.next = nil
+            }
+        }
+    }
+
+    /// The longest delay the wheel holds, in milliseconds.
+    internal var maxMilliseconds: UInt64 {
+        return TimerWheel.MAX_TICKS * resolution
+    }
+
+    internal static func monotonicMilliseconds() -> UInt64 {
+        return DispatchTime.now().uptimeNanoseconds / 1_000_000
+    }
+
+    internal func ticks(for milliseconds: UInt64) -> UInt64 {
+        let ticks = (milliseconds + resolution - 1) / resolution
+        return max(1, min(ticks, TimerWheel.MAX_TICKS))
+    }
+
+    internal func add(_ timer: CarrierTimer) {
+        guard !timer.isLinked else {
+            return
+        }
+
+        timer.expires = current + ticks(for: timer.interval)
+        insert(timer)
+        count += 1
+    }
+
+    internal func remove(_ timer: CarrierTimer) {
+        guard timer.isLinked else {
+            return
+        }
+
+        timer.unlink()
+        count -= 1
+    }
+
+    /// Milliseconds until the lowest level may expire timers, or nil if
+    /// there are no timers.
+    internal func millisecondsToNextExpiration() -> UInt64? {
+        guard count > 0 else {
+            return nil
+        }
+
+        let slots = wheels[0]
+        var ticks: UInt64 = 1
+        while ticks < UInt64(TimerWheel.SLOTS) {
+            let index = Int((current + ticks) & UInt64(TimerWheel.SLOTS - 1))
+            if slots[index].next !== slots[index] {
+                break
+            }
+            ticks += 1
+        }
+
+        return ticks * resolution
+    }
+
+    /// Turn the wheel up to current time and run expired timers.
+    internal func advance() {
+        let target = (TimerWheel.monotonicMilliseconds() - origin) / resolution
+
+        guard count > 0 else {
+            current = max(current, target)
+            return
+        }
+
+        while current < target && count > 0 {
+            tick()
+        }
+        current = max(current, target)
+    }
+
+    private func insert(_ timer: CarrierTimer) {
+        let delta = timer.expires > current ? timer.expires - current : 0
+        var level = 0
+
+        while level < TimerWheel.LEVELS - 1 &&
+            delta >= (1 << (TimerWheel.SLOT_BITS * UInt64(level + 1))) {
+            level += 1
+        }
+
+        let shift = TimerWheel.SLOT_BITS * UInt64(level)
+        let index = Int((timer.expires >> shift) & UInt64(TimerWheel.SLOTS - 1))
+        let head = wheels[level][index]
+
+        timer.prev = head.prev
+        timer.next = head
+        head.prev!.next = timer
+        head.prev = timer
+    }
+
+    private func tick() {
+        current += 1
+
+        var level = 1
+        while level < TimerWheel.LEVELS &&
+            current & ((1 << (TimerWheel.SLOT_BITS * UInt64(level))) - 1) == 0 {
+            level += 1
+        }
+
+        for l in stride(from: level - 1, through: 1, by: -1) {
+            let shift = TimerWheel.SLOT_BITS * UInt64(l)
+            let index = Int((current >> shift) & UInt64(TimerWheel.SLOTS - 1))
+            let head = wheels[l][index]
+
+            while head.next !== head {
+                let timer = head.next!
+                timer.unlink()
+                insert(timer)
+            }
+        }
+
+        let head = wheels[0][Int(current & UInt64(TimerWheel.SLOTS - 1))]
+        while head.next !== head {
+            let timer = head.next!
+            remove(timer)
+
+            if timer.isCancelled {
+                continue
+            }
+
+            timer.handler?(timer)
+
+            if timer.repeats && !timer.isCancelled {
+                add(timer)
+            }
+        }
+    }
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2018 Elastos Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+  
+/*
+ * Copyright (c) 2019 ioeXNetwork
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import Foundation
+
+/// Per-friend and per-node traffic counters, updated on the send and
+/// receive paths of carrier node.
+///
+/// Counters live in preallocated slots indexed by friend handle, in
+/// chunks of 256 friends allocated on first use, and are updated with
+/// atomic adds only. Snapshots read the slots without stopping writers.
+/// Send failures by error code and file progress, which are rare or keyed
+/// by file, are kept under the counters lock.
+internal final class TrafficCounters {
+
+    internal struct Counters {
+        var messagesSent: Int = 0
+        var bytesSent: Int = 0
+        var messagesReceived: Int = 0
+        var bytesReceived: Int = 0
+        var sendFailures = [Int: Int]()
+        var invitesSent: Int = 0
+        var invitesReceived: Int = 0
+        var fileBytes: Int = 0
+    }
+
+    private enum Field: Int {
+        case MessagesSent = 0
+        case BytesSent
+        case MessagesReceived
+        case BytesReceived
+        case InvitesSent
+        case InvitesReceived
+        case FileBytes
+
+        static let count: Int = 7
+    }
+
+    private static let CHUNK_BITS: Int = 8
+    private static let CHUNK_SLOTS: Int = 1 << CHUNK_BITS
+    private static let MAX_CHUNKS: Int = 256
+
+    private let friendTable: FriendTable
+    private let node: UnsafeMutablePointer<Int64>
+    private let chunks: UnsafeMutablePointer<UnsafeMutableRawPointer?>
+
+    private var nodeFailures = [Int: Int]()
+    private var friendFailures = [Int: [Int: Int]]()
+    private var fileProgress = [String: UInt64]()
+
+    internal init(_ friendTable: FriendTable) {
+        self.friendTable = friendTable
+        node = UnsafeMutablePointer<Int64>.allocate(capacity: Field.count)
+        node.initialize(to: 0, count: Field.count)
+        chunks = UnsafeMutablePointer<UnsafeMutableRawPointer?>.allocate(capacity: TrafficCounters.MAX_CHUNKS)
+        chunks.initialize(to: nil, count: TrafficCounters.MAX_CHUNKS)
+    }
+
+    deinit {
+        for index in 0..<TrafficCounters.MAX_CHUNKS {
+            if let chunk = chunks[index] {
+                chunk.assumingMemoryBound(to: Int64.self)
+                    .deallocate(capacity: TrafficCounters.CHUNK_SLOTS * Field.count)
+            }
+        }
+        chunks.deallocate(capacity: TrafficCounters.MAX_CHUNKS)
+        node.deallocate(capacity: Field.count)
+    }
+
+    internal func didSend(_ handle: Int, _ bytes: Int) {
+        add(handle, .MessagesSent, 1)
+        add(handle, .BytesSent, Int64(bytes))
+    }
+
+    /// Count a send failure, to the friend too if its handle is known.
+    internal func didFailToSend(_ handle: Int?, _ errno: Int) {
+        objc_sync_enter(self)
+        defer {
+            objc_sync_exit(self)
+        }
+
+        nodeFailures[errno] = (nodeFailures[errno] ?? 0) + 1
+        if let handle = handle {
+            friendFailures[handle, default: [Int: Int]()][errno, default: 0] += 1
+        }
+    }
+
+    internal func didReceive(_ handle: Int, _ bytes: Int) {
+        add(handle, .MessagesReceived, 1)
+        add(handle, .BytesReceived, Int64(bytes))
+    }
+
+    internal func didSendInvite(_ handle: Int) {
+        add(handle, .InvitesSent, 1)
+    }
+
+    internal func didReceiveInvite(_ handle: Int) {
+        add(handle, .InvitesReceived, 1)
+    }
+
+    /// Count the bytes transferred since the last progress of the file.
+    internal func didTransferFile(_ handle: Int, _ fileId: String,
+                                  _ transferred: UInt64) {
+        objc_sync_enter(self)
+        let last = fileProgress[fileId] ?? 0
+        fileProgress[fileId] = transferred
+        objc_sync_exit(self)
+
+        if transferred > last {
+            add(handle, .FileBytes, Int64(clamping: transferred - last))
+        }
+    }
+
+    internal func didFinishFile(_ fileId: String) {
+        objc_sync_enter(self)
+        fileProgress[fileId] = nil
+        objc_sync_exit(self)
+    }
+
+    internal func snapshot() -> CarrierTrafficSnapshot {
+        objc_sync_enter(self)
+        var nodeCounters = TrafficCounters.read(node)
+        nodeCounters.sendFailures = nodeFailures
+        let failures = friendFailures
+        objc_sync_exit(self)
+
+        var friendStats = [String: CarrierTrafficStats]()
+
+        for chunk in 0..<TrafficCounters.MAX_CHUNKS {
+            guard let raw = chunks[chunk] else {
+                continue
+            }
+
+            let base = raw.assumingMemoryBound(to: Int64.self)
+            for index in 0..<TrafficCounters.CHUNK_SLOTS {
+                let handle = (chunk << TrafficCounters.CHUNK_BITS) + index + 1
+                var counters = TrafficCounters.read(base + index * Field.count)
+                counters.sendFailures = failures[handle] ?? [:]
+
+                if TrafficCounters.isActive(counters),
+                    let friendId = friendTable.id(of: handle) {
+                    friendStats[friendId] = CarrierTrafficStats(counters)
+                }
+            }
+        }
+
+        // Friends with failures only have no slot allocated yet.
+        for (handle, sendFailures) in failures {
+            if let friendId = friendTable.id(of: handle), friendStats[friendId] == nil {
+                var counters = Counters()
+                counters.sendFailures = sendFailures
+                friendStats[friendId] = CarrierTrafficStats(counters)
+            }
+        }
+
+        return CarrierTrafficSnapshot(CarrierTrafficStats(nodeCounters), friendStats)
+    }
+
+    private func add(_ handle: Int, _ field: Field, _ value: Int64) {
+        OSAtomicAdd64Barrier(value, node + field.rawValue)
+        if let slot = slot(handle) {
+            OSAtomicAdd64Barrier(value, slot + field.rawValue)
+        }
+    }
+
+    /// The counters of the friend, allocating its chunk on first use.
+    private func slot(_ handle: Int) -> UnsafeMutablePointer<Int64>? {
+        let index = handle - 1
+        let chunk = index >> TrafficCounters.CHUNK_BITS
+        guard index >= 0 && chunk < TrafficCounters.MAX_CHUNKS else {
+            return nil
+        }
+
+        var raw = chunks[chunk]
+        if raw == nil {
+            let count = TrafficCounters.CHUNK_SLOTS * Field.count
+            let fresh = UnsafeMutablePointer<Int64>.allocate(capacity: count)
+            fresh.initialize(to: 0, count: count)
+
+            if OSAtomicCompareAndSwapPtrBarrier(nil, UnsafeMutableRawPointer(fresh),
+                                                chunks + chunk) {
+                raw = UnsafeMutableRawPointer(fresh)
+            } else {
+                fresh.deallocate(capacity: count)
+                raw = chunks[chunk]
+            }
+        }
+
+        return raw!.assumingMemoryBound(to: Int64.self) +
+            (index & (TrafficCounters.CHUNK_SLOTS - 1)) * Field.count
+    }
+
+    private static func read(_ slot: UnsafeMutablePointer<Int64>) -> Counters {
+        let value = { (field: Field) -> Int in
+            return Int(clamping: OSAtomicAdd64Barrier(0, slot + field.rawValue))
+        }
+
+        var counters = Counters()
+        counters.messagesSent = value(.MessagesSent)
+        counters.bytesSent = value(.BytesSent)
+        counters.messagesReceived = value(.MessagesReceived)
+        counters.bytesReceived = value(.BytesReceived)
+        counters.invitesSent = value(.InvitesSent)
+        counters.invitesReceived = value(.InvitesReceived)
+        counters.fileBytes = value(.FileBytes)
+        return counters
+    }
+
+    private static func isActive(_ counters: Counters) -> Bool {
+        return counters.messagesSent > 0 || counters.messagesReceived > 0 ||
+            counters.invitesSent > 0 || counters.invitesReceived > 0 ||
+            counters.fileBytes > 0 || !counters.sendFailures.isEmpty
+    }
+}
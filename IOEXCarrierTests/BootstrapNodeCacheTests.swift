@@ -0,0 +1,66 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class BootstrapNodeCacheTests: XCTestCase {
+
+    private var location: String!
+
+    override func setUp() {
+        super.setUp()
+        location = (NSTemporaryDirectory() as NSString)
+            .appendingPathComponent("bootstrap-\(UUID().uuidString)")
+        try! FileManager.default.createDirectory(atPath: location,
+                                                 withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(atPath: location)
+        super.tearDown()
+    }
+
+    private func node(_ ipv4: String) -> BootstrapNode {
+        let node = BootstrapNode()
+        node.ipv4 = ipv4
+        node.port = "33445"
+        node.publicKey = "key-\(ipv4)"
+        return node
+    }
+
+    func testConnectedNodesAreCachedAheadOfConfigured() {
+        let first = BootstrapNodeCache(location)
+        _ = first.bootstrapNodes(with: [node("10.0.0.1")])
+        first.recordConnected()
+
+        let second = BootstrapNodeCache(location)
+        let nodes = second.bootstrapNodes(with: [node("10.0.0.2")])
+        XCTAssertEqual(nodes.map { $0.ipv4! }, ["10.0.0.1", "10.0.0.2"])
+    }
+
+    func testRunsWithoutConnectionAreNotCredited() {
+        let first = BootstrapNodeCache(location)
+        _ = first.bootstrapNodes(with: [node("10.0.0.1")])
+        first.recordFailure()
+        first.recordConnected()
+
+        let second = BootstrapNodeCache(location)
+        XCTAssertEqual(second.bootstrapNodes(with: []).count, 0)
+    }
+
+    func testNodesMissingRunsAreRemoved() {
+        for _ in 0..<5 {
+            let cache = BootstrapNodeCache(location)
+            _ = cache.bootstrapNodes(with: [node("10.0.0.1")])
+            cache.recordConnected()
+        }
+
+        for _ in 0..<3 {
+            let cache = BootstrapNodeCache(location)
+            XCTAssertEqual(cache.bootstrapNodes(with: []).count, 1)
+            cache.recordFailure()
+        }
+
+        let last = BootstrapNodeCache(location)
+        XCTAssertEqual(last.bootstrapNodes(with: []).count, 0)
+    }
+}
@@ -0,0 +1,72 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Compare the fixed and the adaptive event loop on a loopback node, for
+/// the latency of work submitted to the loop and for idle CPU usage.
+class CarrierLoopBenchmarkTests: XCTestCase {
+
+    private var location: String!
+    private var carrier: Carrier!
+
+    override func setUp() {
+        super.setUp()
+        location = TestCarrierNode.makeLocation()
+        carrier = try! TestCarrierNode.create(location)
+    }
+
+    override func tearDown() {
+        carrier.kill()
+        try? FileManager.default.removeItem(atPath: location)
+        super.tearDown()
+    }
+
+    /// Run no-op commands on the loop one after another, each waiting for
+    /// the previous one to complete.
+    private func roundTrips(_ count: Int) {
+        let done = DispatchSemaphore(value: 0)
+
+        for _ in 0..<count {
+            carrier.submit({ _ in }, completion: { (_, _) in done.signal() })
+            done.wait()
+        }
+    }
+
+    /// CPU time used by the process per second while the node is idle.
+    private func idleCpuTime(_ seconds: TimeInterval) -> TimeInterval {
+        roundTrips(1)
+
+        let before = TestCarrierNode.cpuTime()
+        Thread.sleep(forTimeInterval: seconds)
+        return (TestCarrierNode.cpuTime() - before) / seconds
+    }
+
+    func testFixedLoopCommandLatency() {
+        try! carrier.start(iterateInterval: 50)
+
+        measure {
+            roundTrips(20)
+        }
+    }
+
+    func testAdaptiveLoopCommandLatency() {
+        try! carrier.start(minInterval: 5, maxInterval: 50)
+
+        measure {
+            roundTrips(20)
+        }
+    }
+
+    func testFixedLoopIdleCpu() {
+        try! carrier.start(iterateInterval: 5)
+
+        let cpu = idleCpuTime(2)
+        print(String(format: "Fixed 5ms loop idle CPU: %.2f ms/s", cpu * 1000))
+    }
+
+    func testAdaptiveLoopIdleCpu() {
+        try! carrier.start(minInterval: 5, maxInterval: 50)
+
+        let cpu = idleCpuTime(2)
+        print(String(format: "Adaptive 5-50ms loop idle CPU: %.2f ms/s", cpu * 1000))
+    }
+}
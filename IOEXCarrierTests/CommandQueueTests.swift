@@ -0,0 +1,73 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class CommandQueueTests: XCTestCase {
+
+    func testDrainRunsInSubmissionOrder() {
+        let queue = CommandQueue()
+        var order = [Int]()
+
+        for i in 0..<5 {
+            XCTAssertTrue(queue.push { order.append(i) })
+        }
+
+        XCTAssertEqual(queue.drain(), 5)
+        XCTAssertEqual(order, [0, 1, 2, 3, 4])
+        XCTAssertEqual(queue.drain(), 0)
+    }
+
+    func testCommandsPushedWhileDrainingRunNextTime() {
+        let queue = CommandQueue()
+        var order = [Int]()
+
+        queue.push {
+            order.append(1)
+            queue.push { order.append(2) }
+        }
+
+        XCTAssertEqual(queue.drain(), 1)
+        XCTAssertEqual(order, [1])
+        XCTAssertEqual(queue.drain(), 1)
+        XCTAssertEqual(order, [1, 2])
+    }
+
+    func testCloseRunsPendingAndRejectsLaterPushes() {
+        let queue = CommandQueue()
+        var ran = 0
+        var pushedWhileClosing = true
+
+        queue.push {
+            ran += 1
+            pushedWhileClosing = queue.push { ran += 1 }
+        }
+        queue.close()
+
+        XCTAssertEqual(ran, 1)
+        XCTAssertFalse(pushedWhileClosing)
+        XCTAssertFalse(queue.push { ran += 1 })
+        XCTAssertEqual(queue.drain(), 0)
+        XCTAssertEqual(ran, 1)
+    }
+
+    func testConcurrentProducers() {
+        let queue = CommandQueue()
+        let counter = UnsafeMutablePointer<Int32>.allocate(capacity: 1)
+        counter.initialize(to: 0)
+        defer {
+            counter.deallocate(capacity: 1)
+        }
+
+        DispatchQueue.concurrentPerform(iterations: 8) { _ in
+            for _ in 0..<1000 {
+                queue.push { counter.pointee += 1 }
+            }
+        }
+
+        var executed = 0
+        while executed < 8000 {
+            executed += queue.drain()
+        }
+        XCTAssertEqual(counter.pointee, 8000)
+    }
+}
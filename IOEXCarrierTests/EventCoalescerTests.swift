@@ -0,0 +1,58 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class EventCoalescerTests: XCTestCase {
+
+    private func flush(_ coalescer: EventCoalescer) -> [CarrierFriendStateChange] {
+        return coalescer.flush(status: { _ in .Connected }, presence: { _ in .Away })
+    }
+
+    func testOnlyNetFinalStateIsReported() {
+        let coalescer = EventCoalescer(window: 1)
+
+        coalescer.add("alice", 1, oldStatus: .Disconnected, status: .Connected)
+        coalescer.add("alice", 1, oldStatus: .Connected, status: .Disconnected)
+        coalescer.add("alice", 1, oldStatus: .Disconnected, status: .Connected)
+        XCTAssertFalse(coalescer.isEmpty)
+
+        let changes = flush(coalescer)
+        XCTAssertEqual(changes.count, 1)
+        XCTAssertEqual(changes[0].friendId, "alice")
+        XCTAssertEqual(changes[0].friendHandle, 1)
+        XCTAssertTrue(changes[0].statusChanged)
+        XCTAssertEqual(changes[0].status, .Connected)
+        XCTAssertFalse(changes[0].presenceChanged)
+        XCTAssertEqual(changes[0].presence, .Away)
+
+        XCTAssertEqual(coalescer.coalesced, 2)
+        XCTAssertTrue(coalescer.isEmpty)
+    }
+
+    func testFlappingBackToOriginalStateIsDropped() {
+        let coalescer = EventCoalescer(window: 1)
+
+        coalescer.add("alice", 1, oldStatus: .Connected, status: .Disconnected)
+        coalescer.add("alice", 1, oldStatus: .Disconnected, status: .Connected)
+        coalescer.add("bob", 2, oldPresence: .None, presence: .Busy)
+        coalescer.add("bob", 2, oldPresence: .Busy, presence: .None)
+
+        XCTAssertTrue(flush(coalescer).isEmpty)
+        XCTAssertEqual(coalescer.coalesced, 4)
+    }
+
+    func testChangesKeepOrderOfFirstEvent() {
+        let coalescer = EventCoalescer(window: 1)
+
+        coalescer.add("bob", 2, oldPresence: .None, presence: .Busy)
+        coalescer.add("alice", 1, oldStatus: nil, status: .Connected)
+        coalescer.add("bob", 2, oldStatus: .Connected, status: .Disconnected)
+
+        let changes = flush(coalescer)
+        XCTAssertEqual(changes.map { $0.friendId }, ["bob", "alice"])
+        XCTAssertTrue(changes[0].statusChanged && changes[0].presenceChanged)
+        XCTAssertEqual(changes[0].status, .Disconnected)
+        XCTAssertEqual(changes[0].presence, .Busy)
+        XCTAssertEqual(changes[1].presence, .Away)
+    }
+}
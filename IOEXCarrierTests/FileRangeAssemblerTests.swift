@@ -0,0 +1,101 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class FileRangeAssemblerTests: XCTestCase {
+
+    private let friendId = "friend"
+    private let filename = "movie.mp4"
+
+    private func frame<T>(_ data: Data, _ body: (UnsafeRawBufferPointer) -> T) -> T {
+        return data.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> T in
+            return body(UnsafeRawBufferPointer(start: ptr, count: data.count))
+        }
+    }
+
+    private func request(_ fileId: String, _ filename: String? = nil) -> FileRangeRequest {
+        return FileRangeRequest(fileId: fileId, friendId: friendId,
+                                filename: filename ?? self.filename, filesize: 1000)
+    }
+
+    private func announce(_ assembler: FileRangeAssembler, _ rangeCount: Int) -> FileRangeTransfer {
+        return frame(FileRangeAssembler.announce(filename, rangeCount)) {
+            assembler.didReceiveAnnounce(friendId, $0)
+        }!
+    }
+
+    func testListedRequestsMakeTransferInRangeOrder() {
+        let assembler = FileRangeAssembler()
+        let transfer = announce(assembler, 3)
+
+        XCTAssertTrue(assembler.didReceiveRequest(request("b")).handled)
+        XCTAssertTrue(assembler.didReceiveRequest(request("other")).handled)
+        XCTAssertTrue(assembler.didReceiveRequest(request("a")).handled)
+
+        let list = frame(FileRangeAssembler.list(filename, ["a", "b", "c"])) {
+            assembler.didReceiveList(friendId, $0)
+        }
+        XCTAssertNil(list.ready)
+        XCTAssertEqual(list.released.map { $0.fileId }, ["other"])
+
+        let last = assembler.didReceiveRequest(request("c"))
+        XCTAssertTrue(last.handled)
+        XCTAssertTrue(last.ready === transfer)
+        XCTAssertEqual(transfer.fileIds, ["a", "b", "c"])
+        XCTAssertTrue(assembler.transfer(transfer.transferId) === transfer)
+
+        XCTAssertFalse(assembler.didReceiveRequest(request("d")).handled)
+    }
+
+    func testOtherFilesAreNotHeld() {
+        let assembler = FileRangeAssembler()
+        _ = announce(assembler, 2)
+
+        XCTAssertFalse(assembler.didReceiveRequest(request("a", "other.mp4")).handled)
+    }
+
+    func testExpiredAnnounceReleasesHeldRequests() {
+        let assembler = FileRangeAssembler()
+        let transfer = announce(assembler, 2)
+
+        XCTAssertTrue(assembler.didReceiveRequest(request("a")).handled)
+
+        let expired = assembler.expire(transfer)
+        XCTAssertEqual(expired.released.map { $0.fileId }, ["a"])
+        XCTAssertTrue(expired.requested.isEmpty)
+
+        XCTAssertFalse(assembler.didReceiveRequest(request("b")).handled)
+        let list = frame(FileRangeAssembler.list(filename, ["a", "b"])) {
+            assembler.didReceiveList(friendId, $0)
+        }
+        XCTAssertNil(list.ready)
+    }
+
+    func testExpireIgnoresReadyTransfer() {
+        let assembler = FileRangeAssembler()
+        let transfer = announce(assembler, 1)
+
+        _ = frame(FileRangeAssembler.list(filename, ["a"])) {
+            assembler.didReceiveList(friendId, $0)
+        }
+        XCTAssertTrue(assembler.didReceiveRequest(request("a")).ready === transfer)
+
+        let expired = assembler.expire(transfer)
+        XCTAssertTrue(expired.released.isEmpty && expired.requested.isEmpty)
+        XCTAssertTrue(assembler.transfer(transfer.transferId) === transfer)
+    }
+
+    func testRangeProgressUsesAbsoluteOffsets() {
+        let transfer = FileRangeTransfer(1, friendId, filename, 3)
+        transfer.filesize = 1000
+        transfer.split()
+
+        XCTAssertEqual(transfer.starts, [0, 333, 666])
+        XCTAssertEqual(transfer.lengths, [333, 333, 334])
+        XCTAssertEqual(transfer.totalTransferred, 0)
+
+        transfer.transferred[1] = 433
+        transfer.transferred[2] = 2000
+        XCTAssertEqual(transfer.totalTransferred, 100 + 334)
+    }
+}
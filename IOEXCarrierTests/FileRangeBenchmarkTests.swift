@@ -0,0 +1,85 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Compare receiving a 32 MB file as one range with receiving it as four
+/// ranges assembled into place.
+///
+/// The native writes are simulated: a single range is written straight
+/// into the destination, and each range into its own part file at its
+/// absolute offset. The multi-range side then also preallocates the
+/// destination and copies the ranges into place. Transfer time over the
+/// network, where ranges run over separate paths, needs two befriended
+/// nodes on a live carrier network and is not covered.
+class FileRangeBenchmarkTests: XCTestCase {
+
+    private static let FILE_SIZE: Int = 32 * 1024 * 1024
+
+    private var directory: String!
+    private var payload: Data!
+
+    override func setUp() {
+        super.setUp()
+        directory = TestCarrierNode.makeLocation()
+
+        var bytes = [UInt8](repeating: 0, count: FileRangeBenchmarkTests.FILE_SIZE)
+        for index in stride(from: 0, to: bytes.count, by: 4096) {
+            bytes[index] = UInt8(truncatingIfNeeded: index >> 12)
+        }
+        payload = Data(bytes)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(atPath: directory)
+        super.tearDown()
+    }
+
+    private func write(_ path: String, _ data: Data, at offset: Int64) {
+        if !FileManager.default.fileExists(atPath: path) {
+            FileManager.default.createFile(atPath: path, contents: nil, attributes: nil)
+        }
+
+        let handle = FileHandle(forWritingAtPath: path)!
+        handle.seek(toFileOffset: UInt64(offset))
+        handle.write(data)
+        handle.closeFile()
+    }
+
+    func testSingleRange() {
+        let fullpath = (directory as NSString).appendingPathComponent("single.bin")
+
+        measure {
+            try? FileManager.default.removeItem(atPath: fullpath)
+            write(fullpath, payload, at: 0)
+        }
+    }
+
+    func testMultiRangeAssembly() {
+        let assembler = FileRangeAssembler()
+        let fullpath = (directory as NSString).appendingPathComponent("multi.bin")
+
+        measure {
+            let transfer = FileRangeTransfer(1, "friend", "multi.bin", 4)
+            transfer.filesize = Int64(payload.count)
+
+            let done = DispatchSemaphore(value: 0)
+            var result: String?
+            try! assembler.accept(transfer, directory, "multi.bin", nil) { (path, _) in
+                result = path
+                done.signal()
+            }
+
+            for index in 0..<transfer.rangeCount {
+                let start = Int(transfer.starts[index])
+                let end = start + Int(transfer.lengths[index])
+                write(transfer.partPaths[index], payload.subdata(in: start..<end),
+                      at: transfer.starts[index])
+                assembler.copy(transfer, index)
+            }
+
+            done.wait()
+            XCTAssertEqual(result, fullpath)
+        }
+
+        XCTAssertEqual(FileManager.default.contents(atPath: fullpath), payload)
+    }
+}
@@ -0,0 +1,50 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class FriendInfoViewTests: XCTestCase {
+
+    private func friendInfo(_ userId: String, _ name: String) -> CFriendInfo {
+        var cinfo = CFriendInfo()
+        userId.writeToCCharPointer(&cinfo.user_info.userid)
+        name.writeToCCharPointer(&cinfo.user_info.name)
+        cinfo.status = Int32(CarrierConnectionStatus.Connected.rawValue)
+        return cinfo
+    }
+
+    func testFieldsDecodeFromCopy() {
+        let view = CarrierFriendInfoView(friendInfo("alice", "Alice"))
+
+        XCTAssertEqual(view.userId, "alice")
+        XCTAssertEqual(view.name, "Alice")
+        XCTAssertEqual(view.status, .Connected)
+        XCTAssertEqual(view.materialize().userId, "alice")
+    }
+
+    func testUpdatedViewLeavesOriginalUnchanged() {
+        let view = CarrierFriendInfoView(friendInfo("alice", "Alice"))
+        let updated = view.updated(status: .Disconnected)
+
+        XCTAssertEqual(view.status, .Connected)
+        XCTAssertEqual(updated.status, .Disconnected)
+        XCTAssertEqual(updated.userId, "alice")
+    }
+
+    func testConcurrentMaterializeSharesOneResult() {
+        let view = CarrierFriendInfoView(friendInfo("alice", "Alice"))
+        var results = [CarrierFriendInfo?](repeating: nil, count: 16)
+        let lock = NSLock()
+
+        DispatchQueue.concurrentPerform(iterations: results.count) { (index) in
+            let info = view.materialize()
+            _ = view.name
+            lock.lock()
+            results[index] = info
+            lock.unlock()
+        }
+
+        for info in results {
+            XCTAssertTrue(info === results[0])
+        }
+    }
+}
@@ -0,0 +1,100 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class FriendStoreTests: XCTestCase {
+
+    private func friend(_ userId: String, _ status: CarrierConnectionStatus = .Disconnected,
+                        _ presence: CarrierPresenceStatus = .None) -> CarrierFriendInfo {
+        let info = CarrierFriendInfo()
+        info.userId = userId
+        info.status = status
+        info.presence = presence
+        return info
+    }
+
+    private func view(_ userId: String, _ status: CarrierConnectionStatus) -> CarrierFriendInfoView {
+        var cinfo = CFriendInfo()
+        userId.writeToCCharPointer(&cinfo.user_info.userid)
+        cinfo.status = Int32(status.rawValue)
+        return CarrierFriendInfoView(cinfo)
+    }
+
+    func testIndexesFollowStatusAndPresence() {
+        let store = FriendStore()
+        store.update(friend("alice", .Connected, .Away))
+        store.update(friend("bob"))
+        store.update(view("carol", .Connected))
+
+        XCTAssertEqual(Set(store.friendIds(withStatus: .Connected)), ["alice", "carol"])
+        XCTAssertEqual(store.friends(withPresence: .Away).map { $0.userId! }, ["alice"])
+
+        store.updateStatus("alice", .Disconnected)
+        store.updateStatus("bob", .Connected)
+        store.updatePresence("carol", .Busy)
+
+        XCTAssertEqual(Set(store.friendIds(withStatus: .Connected)), ["bob", "carol"])
+        XCTAssertEqual(store.status(of: "alice"), .Disconnected)
+        XCTAssertEqual(store.friends(withPresence: .Busy).map { $0.userId! }, ["carol"])
+        XCTAssertEqual(store.friends(withPresence: .Away).map { $0.userId! }, ["alice"])
+    }
+
+    func testHandedOutInfoIsNotMutated() {
+        let store = FriendStore()
+        store.update(friend("alice", .Connected))
+
+        let before = store.get("alice")!
+        store.updateStatus("alice", .Disconnected)
+        store.updateLabel("alice", "work")
+
+        XCTAssertEqual(before.status, .Connected)
+        XCTAssertNil(before.label)
+        XCTAssertEqual(store.get("alice")!.label, "work")
+        XCTAssertEqual(store.friendIds(withLabel: "work"), ["alice"])
+    }
+
+    func testChangesSinceRevisionReportLatestOnly() {
+        let store = FriendStore()
+        store.update(friend("alice"))
+        let base = store.revision
+
+        store.update(friend("bob"))
+        store.updateStatus("alice", .Connected)
+        store.updateStatus("alice", .Disconnected)
+        store.remove("bob")
+
+        let changes = store.changes(since: base)
+        XCTAssertEqual(changes.revision, store.revision)
+        XCTAssertFalse(changes.isFullSnapshot)
+        XCTAssertEqual(changes.changed.map { $0.userId! }, ["alice"])
+        XCTAssertEqual(changes.changed[0].status, .Disconnected)
+        XCTAssertEqual(changes.removed, ["bob"])
+
+        XCTAssertTrue(store.changes(since: store.revision).changed.isEmpty)
+    }
+
+    func testRemovedFriendLeavesIndexes() {
+        let store = FriendStore()
+        store.update(friend("alice", .Connected))
+        store.remove("alice")
+
+        XCTAssertFalse(store.contains("alice"))
+        XCTAssertNil(store.status(of: "alice"))
+        XCTAssertTrue(store.friendIds(withStatus: .Connected).isEmpty)
+    }
+
+    func testCompactedChangesFallBackToSnapshot() {
+        let store = FriendStore()
+        store.update(friend("alice"))
+
+        for i in 0...1025 {
+            store.update(friend("temp\(i)"))
+            store.remove("temp\(i)")
+        }
+
+        let changes = store.changes(since: 0)
+        XCTAssertTrue(changes.isFullSnapshot)
+        XCTAssertEqual(changes.changed.map { $0.userId! }, ["alice"])
+        XCTAssertTrue(changes.removed.isEmpty)
+    }
+}
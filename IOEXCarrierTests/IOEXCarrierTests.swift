@@ -1,6 +1,6 @@
 
 import XCTest
-@testable import ElastosCarrier
+@testable import IOEXCarrier
 
 class ElastosCarrierTests: XCTestCase {
     
@@ -0,0 +1,70 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Compare full conversion of native info with lazy views on friend_info
+/// and friend_request storms where the delegate reads one or two fields.
+/// Each converted field is one string allocation, so the view path
+/// allocates one view and the strings actually read.
+class InfoViewBenchmarkTests: XCTestCase {
+
+    private static let STORM: Int = 10_000
+
+    private var friendInfos = [CFriendInfo]()
+    private var userInfos = [CUserInfo]()
+
+    override func setUp() {
+        super.setUp()
+
+        for index in 0..<InfoViewBenchmarkTests.STORM {
+            var cinfo = CFriendInfo()
+            "user-\(index)".writeToCCharPointer(&cinfo.user_info.userid)
+            "Friend \(index)".writeToCCharPointer(&cinfo.user_info.name)
+            "Brief description of friend \(index)".writeToCCharPointer(&cinfo.user_info.description)
+            "Female".writeToCCharPointer(&cinfo.user_info.gender)
+            "+1 555 0100".writeToCCharPointer(&cinfo.user_info.phone)
+            "friend\(index)@example.com".writeToCCharPointer(&cinfo.user_info.email)
+            "Region \(index % 16)".writeToCCharPointer(&cinfo.user_info.region)
+            "Label \(index % 8)".writeToCCharPointer(&cinfo.label)
+            friendInfos.append(cinfo)
+            userInfos.append(cinfo.user_info)
+        }
+    }
+
+    func testFriendInfoStormMaterialized() {
+        measure {
+            for cinfo in friendInfos {
+                let info = convertCFriendInfoToCarrierFriendInfo(cinfo)
+                _ = info.name
+                _ = info.status
+            }
+        }
+    }
+
+    func testFriendInfoStormViews() {
+        measure {
+            for cinfo in friendInfos {
+                let view = CarrierFriendInfoView(cinfo)
+                _ = view.name
+                _ = view.status
+            }
+        }
+    }
+
+    func testFriendRequestStormMaterialized() {
+        measure {
+            for cinfo in userInfos {
+                let info = convertCUserInfoToCarrierUserInfo(cinfo)
+                _ = info.userId
+            }
+        }
+    }
+
+    func testFriendRequestStormViews() {
+        measure {
+            for cinfo in userInfos {
+                let view = CarrierUserInfoView(cinfo)
+                _ = view.userId
+            }
+        }
+    }
+}
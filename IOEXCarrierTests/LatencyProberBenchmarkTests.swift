@@ -0,0 +1,56 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Cost of latency probing on the loop thread: one probe round of pings,
+/// pongs and histogram updates over 5,000 friends.
+class LatencyProberBenchmarkTests: XCTestCase {
+
+    private static let FRIENDS: Int = 5_000
+
+    func testProbeRound() {
+        let prober = LatencyProber(interval: 1)
+        let friendIds = (0..<LatencyProberBenchmarkTests.FRIENDS).map { "friend-\($0)" }
+        for friendId in friendIds {
+            prober.addPeer(friendId)
+        }
+
+        measure {
+            for friendId in prober.peers(of: friendIds) {
+                let ping = prober.ping(friendId)
+
+                ping.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+                    let pong = LatencyProber.pong(UnsafeRawBufferPointer(start: ptr,
+                                                                         count: ping.count))!
+                    pong.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+                        _ = prober.didReceivePong(friendId,
+                                                  UnsafeRawBufferPointer(start: ptr,
+                                                                         count: pong.count))
+                    }
+                }
+            }
+        }
+
+        XCTAssertEqual(prober.stats().count, friendIds.count)
+    }
+
+    func testStatsScrape() {
+        let prober = LatencyProber(interval: 1)
+        for index in 0..<LatencyProberBenchmarkTests.FRIENDS {
+            let friendId = "friend-\(index)"
+            prober.addPeer(friendId)
+
+            let ping = prober.ping(friendId)
+            let pong = ping.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> Data in
+                return LatencyProber.pong(UnsafeRawBufferPointer(start: ptr, count: ping.count))!
+            }
+            pong.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+                _ = prober.didReceivePong(friendId,
+                                          UnsafeRawBufferPointer(start: ptr, count: pong.count))
+            }
+        }
+
+        measure {
+            XCTAssertEqual(prober.stats().count, LatencyProberBenchmarkTests.FRIENDS)
+        }
+    }
+}
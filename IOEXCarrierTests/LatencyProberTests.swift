@@ -0,0 +1,68 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class LatencyProberTests: XCTestCase {
+
+    func testHistogramBuckets() {
+        var histogram = LatencyHistogram()
+        for micros: UInt64 in [500, 1_000, 1_999, 3_000, 100_000_000] {
+            histogram.record(micros)
+        }
+
+        XCTAssertEqual(histogram.buckets[0], 1)
+        XCTAssertEqual(histogram.buckets[1], 2)
+        XCTAssertEqual(histogram.buckets[2], 1)
+        XCTAssertEqual(histogram.buckets[LatencyHistogram.BUCKETS - 1], 1)
+        XCTAssertEqual(histogram.count, 5)
+        XCTAssertEqual(histogram.minMicros, 500)
+        XCTAssertEqual(histogram.maxMicros, 100_000_000)
+    }
+
+    func testHistogramPercentiles() {
+        var histogram = LatencyHistogram()
+        XCTAssertEqual(histogram.percentile(0.5), 0)
+
+        for micros: UInt64 in [500, 1_500, 3_000, 5_000] {
+            histogram.record(micros)
+        }
+        XCTAssertEqual(histogram.percentile(0.25), 1)
+        XCTAssertEqual(histogram.percentile(0.5), 2)
+        XCTAssertEqual(histogram.percentile(1.0), 8)
+
+        histogram.record(100_000_000)
+        XCTAssertEqual(histogram.percentile(1.0), 100_000)
+    }
+
+    func testPingPongRoundTrip() {
+        let prober = LatencyProber(interval: 1)
+        let ping = prober.ping("friend")
+        XCTAssertEqual(ping.count, LatencyProber.FRAME_LENGTH)
+        XCTAssertEqual(ping[1], FrameHeader.TYPE_PING)
+
+        let pong = ping.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> Data? in
+            return LatencyProber.pong(UnsafeRawBufferPointer(start: ptr, count: ping.count))
+        }!
+        XCTAssertEqual(pong[1], FrameHeader.TYPE_PONG)
+        XCTAssertEqual(pong.subdata(in: 2..<pong.count), ping.subdata(in: 2..<ping.count))
+
+        let rtt = pong.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> UInt64? in
+            return prober.didReceivePong("friend",
+                                         UnsafeRawBufferPointer(start: ptr, count: pong.count))
+        }
+        XCTAssertNotNil(rtt)
+
+        let stats = prober.stats("friend")!
+        XCTAssertEqual(stats.sent, 1)
+        XCTAssertEqual(stats.received, 1)
+        XCTAssertNil(prober.stats("other"))
+    }
+
+    func testOnlyKnownPeersAreProbed() {
+        let prober = LatencyProber(interval: 1)
+        XCTAssertTrue(prober.peers(of: ["a", "b"]).isEmpty)
+
+        prober.addPeer("b")
+        XCTAssertEqual(prober.peers(of: ["a", "b", "c"]), ["b"])
+    }
+}
@@ -0,0 +1,36 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class MessageBatchTests: XCTestCase {
+
+    private func unpack(_ batch: Data) -> [Data]? {
+        return batch.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> [Data]? in
+            let bytes = UnsafeRawBufferPointer(start: ptr, count: batch.count)
+            guard FrameHeader.type(of: bytes) == FrameHeader.TYPE_BATCH else {
+                return nil
+            }
+            return MessageBatch.unpack(bytes)?.map { Data($0) }
+        }
+    }
+
+    func testPackUnpackRoundTrip() {
+        let records = [Data([0x41]), Data([0xFA, 0x01, 0x02]), Data(count: 300)]
+        let batch = MessageBatch.pack(records)
+
+        XCTAssertEqual(batch.count, MessageBatch.HEADER_LEN +
+            records.count * MessageBatch.RECORD_HEADER_LEN + 304)
+        XCTAssertEqual(unpack(batch)!, records)
+    }
+
+    func testMalformedBatchIsRejected() {
+        let batch = MessageBatch.pack([Data([0x41, 0x42]), Data([0x43])])
+
+        XCTAssertNil(unpack(batch.subdata(in: 0..<(batch.count - 1))))
+        XCTAssertNil(unpack(batch.subdata(in: 0..<(MessageBatch.HEADER_LEN + 1))))
+
+        var empty = Data([FrameHeader.MAGIC, FrameHeader.TYPE_BATCH])
+        FrameHeader.write16(&empty, 0)
+        XCTAssertNil(unpack(empty))
+    }
+}
@@ -0,0 +1,95 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class MessageFramingTests: XCTestCase {
+
+    /// Handle the frame the way the friend message callback does, and
+    /// return the message delivered to application, if any.
+    private func receive(_ reassembler: MessageReassembler, _ frame: Data) -> Data? {
+        return frame.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) -> Data? in
+            let bytes = UnsafeRawBufferPointer(start: ptr, count: frame.count)
+            guard FrameHeader.type(of: bytes) == FrameHeader.TYPE_FRAGMENT,
+                let header = FrameHeader(bytes) else {
+                return nil
+            }
+
+            let payload = UnsafeRawBufferPointer(start: ptr + FrameHeader.LENGTH,
+                                                 count: frame.count - FrameHeader.LENGTH)
+            return reassembler.add(1, header, payload)
+        }
+    }
+
+    private func message(_ length: Int) -> Data {
+        var data = Data(count: length)
+        for i in 0..<length {
+            data[i] = UInt8(truncatingIfNeeded: i * 7)
+        }
+        return data
+    }
+
+    func testPlainMessageIsNotFrame() {
+        let data = Data([0x41, 0xFA, 0x02])
+        XCTAssertFalse(FrameHeader.needsFraming(data))
+        data.withUnsafeBytes { (ptr: UnsafePointer<UInt8>) in
+            XCTAssertNil(FrameHeader.type(of: UnsafeRawBufferPointer(start: ptr, count: data.count)))
+        }
+    }
+
+    func testMagicLeadingMessageIsDeliveredIntact() {
+        let reassembler = MessageReassembler(limit: 1 << 20)
+
+        for data in [Data([0xFA]), Data([0xFA, FrameHeader.TYPE_PING, 0x00]),
+                     Data([0xFA, FrameHeader.TYPE_FRAGMENT]) + message(64)] {
+            XCTAssertTrue(FrameHeader.needsFraming(data))
+
+            let frames = FrameHeader.fragments(of: data, messageId: 7)!
+            XCTAssertEqual(frames.count, 1)
+            XCTAssertEqual(receive(reassembler, frames[0]), data)
+        }
+    }
+
+    func testFragmentsReassembleInAnyOrder() {
+        let reassembler = MessageReassembler(limit: 1 << 20)
+        let data = message(FrameHeader.FRAGMENT_PAYLOAD_LEN * 2 + 100)
+
+        let frames = FrameHeader.fragments(of: data, messageId: 1)!
+        XCTAssertEqual(frames.count, 3)
+
+        XCTAssertNil(receive(reassembler, frames[2]))
+        XCTAssertNil(receive(reassembler, frames[0]))
+        XCTAssertNil(receive(reassembler, frames[0]))
+        XCTAssertEqual(receive(reassembler, frames[1]), data)
+    }
+
+    func testInterleavedMessagesReassembleSeparately() {
+        let reassembler = MessageReassembler(limit: 1 << 20)
+        let first = message(FrameHeader.FRAGMENT_PAYLOAD_LEN + 1)
+        let second = message(FrameHeader.FRAGMENT_PAYLOAD_LEN + 2)
+
+        let firstFrames = FrameHeader.fragments(of: first, messageId: 1)!
+        let secondFrames = FrameHeader.fragments(of: second, messageId: 2)!
+
+        XCTAssertNil(receive(reassembler, firstFrames[0]))
+        XCTAssertNil(receive(reassembler, secondFrames[1]))
+        XCTAssertEqual(receive(reassembler, firstFrames[1]), first)
+        XCTAssertEqual(receive(reassembler, secondFrames[0]), second)
+    }
+
+    func testMessageOverLimitIsDropped() {
+        let reassembler = MessageReassembler(limit: FrameHeader.FRAGMENT_PAYLOAD_LEN)
+        let data = message(FrameHeader.FRAGMENT_PAYLOAD_LEN + 1)
+
+        for frame in FrameHeader.fragments(of: data, messageId: 1)! {
+            XCTAssertNil(receive(reassembler, frame))
+        }
+    }
+
+    func testTruncatedFragmentIsRejected() {
+        let reassembler = MessageReassembler(limit: 1 << 20)
+        let frame = FrameHeader.fragments(of: message(32), messageId: 1)![0]
+
+        XCTAssertNil(receive(reassembler, frame.subdata(in: 0..<(frame.count - 1))))
+        XCTAssertNil(receive(reassembler, frame.subdata(in: 0..<(FrameHeader.LENGTH - 1))))
+    }
+}
@@ -0,0 +1,63 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Compare a fan-out send to 5,000 ids with 5,000 single sends on a
+/// loopback node.
+///
+/// The ids are not friends of the node, so each native send fails at
+/// the friend lookup. Both sides then measure the wrapper and native
+/// call cost per recipient, without the per-friend encryption a real
+/// send adds to both.
+class MulticastBenchmarkTests: XCTestCase {
+
+    private static let RECIPIENTS: Int = 5_000
+
+    private var location: String!
+    private var carrier: Carrier!
+    private var targets = [String]()
+    private let payload = Data(repeating: 0x41, count: 256)
+
+    override func setUp() {
+        super.setUp()
+        location = TestCarrierNode.makeLocation()
+        carrier = try! TestCarrierNode.create(location)
+        try! carrier.start(iterateInterval: 10)
+
+        for index in 0..<MulticastBenchmarkTests.RECIPIENTS {
+            var bytes = [UInt8](repeating: 0, count: 32)
+            bytes[0] = UInt8(index & 0xFF)
+            bytes[1] = UInt8(index >> 8)
+            bytes[31] = 1
+            targets.append(Base58.encode(bytes))
+        }
+    }
+
+    override func tearDown() {
+        carrier.kill()
+        try? FileManager.default.removeItem(atPath: location)
+        super.tearDown()
+    }
+
+    func testSingleSends() {
+        measure {
+            for target in targets {
+                _ = try? carrier.sendFriendMessage(to: target, withData: payload)
+            }
+        }
+    }
+
+    func testMulticastSend() {
+        measure {
+            let done = DispatchSemaphore(value: 0)
+            var result: CarrierMulticastResult?
+
+            carrier.sendFriendMessage(toFriends: targets, withData: payload) { (_, value) in
+                result = value
+                done.signal()
+            }
+            done.wait()
+
+            XCTAssertEqual(result!.sent.count + result!.failed.count, targets.count)
+        }
+    }
+}
@@ -0,0 +1,30 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class MulticastSendTests: XCTestCase {
+
+    func testResultKeepsTargetsFailedBeforeSending() {
+        let table = FriendTable()
+        let recipients = ["alice", "bob", "carol"].map { (id) -> MulticastSend.Recipient in
+            let handle = table.intern(id)
+            return (handle, id, table.cid(of: handle)!)
+        }
+
+        let multicast = MulticastSend([Data([0x41])], recipients,
+                                      failed: ["bad id": 0x01000001])
+
+        multicast.send(2) { (recipient, _) -> Int in
+            return recipient.id == "bob" ? 0x01000025 : 0
+        }
+        XCTAssertFalse(multicast.isDone)
+
+        multicast.cancel(0x01000012)
+        XCTAssertTrue(multicast.isDone)
+
+        let result = multicast.result()
+        XCTAssertEqual(result.sent, ["alice"])
+        XCTAssertEqual(result.failed, ["bad id": 0x01000001, "bob": 0x01000025,
+                                       "carol": 0x01000012])
+    }
+}
@@ -0,0 +1,154 @@
+import XCTest
+@testable import IOEXCarrier
+
+class OutboundQueueTests: XCTestCase {
+
+    private var location: String!
+
+    override func setUp() {
+        super.setUp()
+        location = (NSTemporaryDirectory() as NSString)
+            .appendingPathComponent("outbound-\(UUID().uuidString)")
+        try! FileManager.default.createDirectory(atPath: location,
+                                                 withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(atPath: location)
+        super.tearDown()
+    }
+
+    private func friendId(_ seed: UInt8) -> String {
+        return Base58.encode([UInt8](repeating: seed, count: 32))
+    }
+
+    private func message(_ text: String) -> Data {
+        return text.data(using: .utf8)!
+    }
+
+    private func queue(capacity: Int = 4) -> OutboundQueue {
+        return OutboundQueue(location, capacity: capacity,
+                             highWatermark: 3, lowWatermark: 1)
+    }
+
+    private func file(of friendId: String) -> String {
+        return (location as NSString)
+            .appendingPathComponent("outbound/" + friendId + ".plist")
+    }
+
+    func testQueuedMessagesSurviveReload() {
+        let alice = friendId(1)
+        let bob = friendId(2)
+
+        let first = queue()
+        _ = first.push(alice, message("a1"))
+        _ = first.push(alice, message("a2"))
+        _ = first.push(bob, message("b1"))
+        first.flush()
+
+        let second = queue()
+        XCTAssertEqual(second.depths(), [alice: 2, bob: 1])
+        XCTAssertEqual(second.peek(alice), message("a1"))
+        _ = second.pop(alice)
+        XCTAssertEqual(second.peek(alice), message("a2"))
+        XCTAssertEqual(second.peek(bob), message("b1"))
+    }
+
+    func testDrainedQueueRemovesItsFile() {
+        let alice = friendId(1)
+
+        let first = queue()
+        _ = first.push(alice, message("a1"))
+        first.flush()
+        XCTAssertTrue(FileManager.default.fileExists(atPath: file(of: alice)))
+
+        _ = first.pop(alice)
+        first.flush()
+        XCTAssertFalse(FileManager.default.fileExists(atPath: file(of: alice)))
+        XCTAssertEqual(queue().depth(alice), 0)
+    }
+
+    func testSaveWritesOnlyChangedQueues() {
+        let alice = friendId(1)
+        let bob = friendId(2)
+
+        let outbound = queue()
+        _ = outbound.push(alice, message("a1"))
+        outbound.flush()
+        try! FileManager.default.removeItem(atPath: file(of: alice))
+
+        _ = outbound.push(bob, message("b1"))
+        outbound.flush()
+        XCTAssertFalse(FileManager.default.fileExists(atPath: file(of: alice)))
+        XCTAssertTrue(FileManager.default.fileExists(atPath: file(of: bob)))
+    }
+
+    func testFullQueueRejectsMessages() {
+        let alice = friendId(1)
+        let outbound = queue(capacity: 3)
+
+        for index in 0..<3 {
+            XCTAssertTrue(outbound.push(alice, message("a\(index)")).accepted)
+        }
+        XCTAssertFalse(outbound.push(alice, message("a3")).accepted)
+        XCTAssertEqual(outbound.depth(alice), 3)
+    }
+
+    func testWatermarksAreReportedOnceEachWay() {
+        let alice = friendId(1)
+        let outbound = queue()
+
+        XCTAssertFalse(outbound.push(alice, message("a1")).high)
+        XCTAssertFalse(outbound.push(alice, message("a2")).high)
+        XCTAssertTrue(outbound.push(alice, message("a3")).high)
+        XCTAssertFalse(outbound.push(alice, message("a4")).high)
+
+        XCTAssertFalse(outbound.pop(alice))
+        XCTAssertFalse(outbound.pop(alice))
+        XCTAssertTrue(outbound.pop(alice))
+        XCTAssertFalse(outbound.pop(alice))
+
+        XCTAssertFalse(outbound.push(alice, message("a5")).high)
+    }
+
+    func testReloadedBacklogKeepsHighWatermarkState() {
+        let alice = friendId(1)
+        let bob = friendId(2)
+
+        let first = queue()
+        for index in 0..<4 {
+            _ = first.push(alice, message("a\(index)"))
+        }
+        _ = first.push(bob, message("b1"))
+        first.flush()
+
+        let second = queue()
+        XCTAssertEqual(second.friendIdsAboveHighWatermark(), [alice])
+        XCTAssertFalse(second.push(alice, message("a4")).accepted)
+
+        XCTAssertFalse(second.pop(alice))
+        XCTAssertFalse(second.pop(alice))
+        XCTAssertTrue(second.pop(alice))
+        XCTAssertTrue(second.friendIdsAboveHighWatermark().isEmpty)
+    }
+
+    func testUnsentHeadIsRetriedBeforeLaterMessages() {
+        let alice = friendId(1)
+        let outbound = queue()
+
+        _ = outbound.push(alice, message("a1"))
+        _ = outbound.push(alice, message("a2"))
+
+        // A failed send leaves the head queued for the retry.
+        XCTAssertEqual(outbound.peek(alice), message("a1"))
+        _ = outbound.push(alice, message("a3"))
+        XCTAssertEqual(outbound.peek(alice), message("a1"))
+
+        var sent = [Data]()
+        while let data = outbound.peek(alice) {
+            sent.append(data)
+            _ = outbound.pop(alice)
+        }
+        XCTAssertEqual(sent, [message("a1"), message("a2"), message("a3")])
+    }
+}
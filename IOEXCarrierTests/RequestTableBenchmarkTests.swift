@@ -0,0 +1,68 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Compare the pooled request table with the retained boxed context used
+/// before it, for 10,000 outstanding invites answered out of order.
+class RequestTableBenchmarkTests: XCTestCase {
+
+    private typealias Handler = (Int) -> Void
+
+    private static let REQUESTS: Int = 10_000
+
+    private let owner = NSObject()
+    private var order = [Int]()
+
+    override func setUp() {
+        super.setUp()
+
+        // Answer the requests in a fixed, shuffled order.
+        var state: UInt32 = 1
+        order = Array(0..<RequestTableBenchmarkTests.REQUESTS)
+        for index in stride(from: order.count - 1, to: 0, by: -1) {
+            state = state &* 1_103_515_245 &+ 12_345
+            order.swapAt(index, Int(state >> 16) % (index + 1))
+        }
+    }
+
+    override func tearDown() {
+        RequestTable.shared.removeAll(ownedBy: owner)
+        super.tearDown()
+    }
+
+    func testPooledRequests() {
+        let table = RequestTable.shared
+        let handler: Handler = { _ in }
+
+        measure {
+            var contexts = [UnsafeMutableRawPointer]()
+            contexts.reserveCapacity(order.count)
+
+            for _ in 0..<order.count {
+                contexts.append(RequestTable.context(table.add(owner, handler)!))
+            }
+            for index in order {
+                let request = table.take(RequestTable.id(contexts[index]))!
+                (request.handler as! Handler)(index)
+            }
+        }
+    }
+
+    func testBoxedContexts() {
+        let handler: Handler = { _ in }
+
+        measure {
+            var contexts = [UnsafeMutableRawPointer]()
+            contexts.reserveCapacity(order.count)
+
+            for _ in 0..<order.count {
+                let context: [AnyObject?] = [owner, handler as AnyObject]
+                contexts.append(Unmanaged.passRetained(context as AnyObject).toOpaque())
+            }
+            for index in order {
+                let context = Unmanaged<AnyObject>.fromOpaque(contexts[index])
+                    .takeRetainedValue() as! [AnyObject?]
+                (context[1] as! Handler)(index)
+            }
+        }
+    }
+}
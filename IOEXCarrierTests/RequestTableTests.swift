@@ -0,0 +1,66 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class RequestTableTests: XCTestCase {
+
+    private let owner = NSObject()
+
+    override func tearDown() {
+        RequestTable.shared.removeAll(ownedBy: owner)
+        super.tearDown()
+    }
+
+    func testTakeReturnsHandlerOnce() {
+        let table = RequestTable.shared
+        let id = table.add(owner, "handler")!
+
+        XCTAssertTrue(table.contains(id))
+        XCTAssertEqual(table.take(id)?.handler as? String, "handler")
+        XCTAssertNil(table.take(id))
+        XCTAssertNil(table.expire(id))
+        XCTAssertFalse(table.contains(id))
+    }
+
+    func testStaleIdOfReusedSlotIsDropped() {
+        let table = RequestTable.shared
+        let first = table.add(owner, "first")!
+        table.remove(first)
+
+        let second = table.add(owner, "second")!
+        XCTAssertNotEqual(first, second)
+        XCTAssertNil(table.take(first))
+        XCTAssertEqual(table.take(second)?.handler as? String, "second")
+    }
+
+    func testIdsSurviveContextRoundTripAcrossGenerations() {
+        let table = RequestTable.shared
+
+        // Reuses the same slot through every generation, and wraps.
+        for _ in 0..<40_000 {
+            let id = table.add(owner, 0)!
+            XCTAssertGreaterThan(id, 0)
+            XCTAssertLessThanOrEqual(id, Int(Int32.max))
+
+            let context = RequestTable.context(id)
+            guard table.take(RequestTable.id(context)) != nil else {
+                XCTFail("Request \(id) dropped")
+                return
+            }
+        }
+    }
+
+    func testRemoveAllOfOwner() {
+        let table = RequestTable.shared
+        let other = NSObject()
+        let mine = table.add(owner, 1)!
+        let theirs = table.add(other, 2)!
+
+        table.removeAll(ownedBy: owner)
+        XCTAssertFalse(table.contains(mine))
+        XCTAssertTrue(table.contains(theirs))
+
+        table.removeAll(ownedBy: other)
+        XCTAssertFalse(table.contains(theirs))
+    }
+}
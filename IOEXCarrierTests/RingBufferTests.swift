@@ -0,0 +1,89 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class RingBufferTests: XCTestCase {
+
+    func testCapacityRoundsUpToPowerOfTwo() {
+        XCTAssertEqual(RingBuffer<Int>(capacity: 1).capacity, 1)
+        XCTAssertEqual(RingBuffer<Int>(capacity: 5).capacity, 8)
+        XCTAssertEqual(RingBuffer<Int>(capacity: 1024).capacity, 1024)
+    }
+
+    func testElementsPopInOrderAcrossWraparound() {
+        let ring = RingBuffer<Int>(capacity: 4)
+
+        for round in 0..<3 {
+            for i in 0..<3 {
+                XCTAssertTrue(ring.push(round * 10 + i))
+            }
+            XCTAssertEqual(ring.count, 3)
+            for i in 0..<3 {
+                XCTAssertEqual(ring.pop(), round * 10 + i)
+            }
+            XCTAssertNil(ring.pop())
+        }
+        XCTAssertEqual(ring.count, 0)
+    }
+
+    func testFullRingDropsAndCounts() {
+        let ring = RingBuffer<Int>(capacity: 2)
+
+        XCTAssertTrue(ring.push(1))
+        XCTAssertTrue(ring.push(2))
+        XCTAssertFalse(ring.push(3))
+        XCTAssertFalse(ring.push(4))
+
+        XCTAssertEqual(ring.dropped, 2)
+        XCTAssertEqual(ring.highWatermark, 2)
+        XCTAssertEqual(ring.pop(), 1)
+        XCTAssertTrue(ring.push(5))
+        XCTAssertEqual(ring.pop(), 2)
+        XCTAssertEqual(ring.pop(), 5)
+    }
+
+    func testEventRecordsRoundTrip() {
+        let ring = RingBuffer<CarrierEvent>(capacity: 8)
+
+        XCTAssertTrue(ring.push(.FriendMessage(3, "friend", Data([0x41, 0x00, 0x42]))))
+        XCTAssertTrue(ring.push(.Ready))
+
+        guard case .FriendMessage(let handle, let from, let data)? = ring.pop() else {
+            return XCTFail("Expected friend message event")
+        }
+        XCTAssertEqual(handle, 3)
+        XCTAssertEqual(from, "friend")
+        XCTAssertEqual(data, Data([0x41, 0x00, 0x42]))
+
+        guard case .Ready? = ring.pop() else {
+            return XCTFail("Expected ready event")
+        }
+    }
+
+    func testConcurrentProducerAndConsumer() {
+        let ring = RingBuffer<Int>(capacity: 64)
+        let total = 100000
+        let done = expectation(description: "producer done")
+
+        DispatchQueue.global().async {
+            var next = 0
+            while next < total {
+                if ring.push(next) {
+                    next += 1
+                }
+            }
+            done.fulfill()
+        }
+
+        var expected = 0
+        while expected < total {
+            if let value = ring.pop() {
+                XCTAssertEqual(value, expected)
+                expected += 1
+            }
+        }
+
+        wait(for: [done], timeout: 10)
+        XCTAssertNil(ring.pop())
+    }
+}
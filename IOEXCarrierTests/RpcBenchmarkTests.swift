@@ -0,0 +1,48 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Calls per second of the RPC wrapper path, with 10,000 calls pipelined
+/// and replied in reverse order.
+///
+/// Each call is encoded, parsed by the callee, replied, and the reply is
+/// parsed and matched to its pending call by call id, as in CarrierRpc.
+/// The native invite round trip is not included: it needs two befriended
+/// nodes, and befriending goes through a live carrier network.
+class RpcBenchmarkTests: XCTestCase {
+
+    private static let CALLS: Int = 10_000
+
+    func testPipelinedCallsOutOfOrder() {
+        let params = "{\"friend\": \"status\", \"verbose\": true}"
+        var rate = 0.0
+
+        measure {
+            let start = Date()
+            var pending = [Int: String]()
+            var calls = [String]()
+            calls.reserveCapacity(RpcBenchmarkTests.CALLS)
+
+            for callId in 1...RpcBenchmarkTests.CALLS {
+                pending[callId] = "getStatus"
+                calls.append(RpcEnvelope.call(callId, "getStatus", params))
+            }
+
+            var replies = [String]()
+            replies.reserveCapacity(calls.count)
+            for text in calls.reversed() {
+                let call = RpcEnvelope.parse(text)!
+                replies.append(RpcEnvelope.reply(call.callId, call.body))
+            }
+
+            for text in replies {
+                let reply = RpcEnvelope.parse(text)!
+                XCTAssertNotNil(pending.removeValue(forKey: reply.callId))
+            }
+            XCTAssertTrue(pending.isEmpty)
+
+            rate = Double(RpcBenchmarkTests.CALLS) / Date().timeIntervalSince(start)
+        }
+
+        print(String(format: "RPC wrapper path: %.0f calls/s", rate))
+    }
+}
@@ -0,0 +1,38 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class RpcEnvelopeTests: XCTestCase {
+
+    func testCallRoundTrip() {
+        let text = RpcEnvelope.call(42, "getStatus", "{\"a\": 1}\nsecond line")
+        let envelope = RpcEnvelope.parse(text)!
+
+        XCTAssertEqual(envelope.callId, 42)
+        XCTAssertEqual(envelope.method, "getStatus")
+        XCTAssertEqual(envelope.body, "{\"a\": 1}\nsecond line")
+    }
+
+    func testReplyRoundTrip() {
+        let envelope = RpcEnvelope.parse(RpcEnvelope.reply(7, ""))!
+
+        XCTAssertEqual(envelope.callId, 7)
+        XCTAssertNil(envelope.method)
+        XCTAssertEqual(envelope.body, "")
+    }
+
+    func testOtherInviteDataIsNotEnvelope() {
+        XCTAssertNil(RpcEnvelope.parse("hello"))
+        XCTAssertNil(RpcEnvelope.parse("#rpc/1 12 method"))
+        XCTAssertNil(RpcEnvelope.parse("#rpc/1 abc method\nbody"))
+        XCTAssertNil(RpcEnvelope.parse("#rpc/1 1 method extra\nbody"))
+        XCTAssertNil(RpcEnvelope.parse("#rpc/2 1 method\nbody"))
+    }
+
+    func testMethodNamesHaveNoWhitespace() {
+        XCTAssertTrue(RpcEnvelope.isValid(method: "friend.ping"))
+        XCTAssertFalse(RpcEnvelope.isValid(method: ""))
+        XCTAssertFalse(RpcEnvelope.isValid(method: "two words"))
+        XCTAssertFalse(RpcEnvelope.isValid(method: "line\nbreak"))
+    }
+}
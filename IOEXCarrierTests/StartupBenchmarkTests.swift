@@ -0,0 +1,79 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Cold and warm starts of nodes bootstrapping from a stand-in node on
+/// the loopback interface, reported as startup trace percentiles.
+///
+/// The stand-in node does not answer, so only the phases up to the first
+/// loop iteration are reached. Connected and ready need a live DHT node.
+class StartupBenchmarkTests: XCTestCase {
+
+    private static let RUNS: Int = 20
+
+    /// Create and start a node, and kill it once its loop has run.
+    private func startOnce(_ location: String) -> CarrierStartupTrace {
+        let carrier = try! TestCarrierNode.create(location)
+        try! carrier.start(iterateInterval: 10)
+
+        let deadline = Date().addingTimeInterval(5)
+        var trace = carrier.getStartupTrace()
+        while trace.loopStarted == nil && Date() < deadline {
+            Thread.sleep(forTimeInterval: 0.001)
+            trace = carrier.getStartupTrace()
+        }
+
+        carrier.kill()
+        return trace
+    }
+
+    private func report(_ name: String, _ traces: [CarrierStartupTrace]) {
+        let phases: [(String, [TimeInterval])] = [
+            ("created", traces.flatMap { $0.created }),
+            ("loopStarted", traces.flatMap { $0.loopStarted })
+        ]
+
+        for (phase, samples) in phases {
+            XCTAssertEqual(samples.count, traces.count)
+            guard !samples.isEmpty else {
+                continue
+            }
+
+            print(String(format: "%@ %@: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms",
+                         name, phase,
+                         TestCarrierNode.percentile(samples, 50) * 1000,
+                         TestCarrierNode.percentile(samples, 90) * 1000,
+                         TestCarrierNode.percentile(samples, 99) * 1000))
+        }
+    }
+
+    func testColdStart() {
+        var traces = [CarrierStartupTrace]()
+
+        for _ in 0..<StartupBenchmarkTests.RUNS {
+            let location = TestCarrierNode.makeLocation()
+            traces.append(startOnce(location))
+            try? FileManager.default.removeItem(atPath: location)
+        }
+
+        XCTAssertFalse(traces.contains { $0.warmStart })
+        report("Cold start", traces)
+    }
+
+    func testWarmStart() {
+        let location = TestCarrierNode.makeLocation()
+        defer {
+            try? FileManager.default.removeItem(atPath: location)
+        }
+
+        // The first run writes the persistent data the others load.
+        _ = startOnce(location)
+
+        var traces = [CarrierStartupTrace]()
+        for _ in 0..<StartupBenchmarkTests.RUNS {
+            traces.append(startOnce(location))
+        }
+
+        XCTAssertFalse(traces.contains { !$0.warmStart })
+        report("Warm start", traces)
+    }
+}
@@ -0,0 +1,58 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Helpers to run real carrier nodes in tests and benchmarks.
+///
+/// The nodes bootstrap from a stand-in node on the loopback interface.
+/// Nothing answers there, so the nodes run their native loop, timers and
+/// persistent data without reaching a carrier network.
+enum TestCarrierNode {
+
+    class Delegate: NSObject, CarrierDelegate {
+        func didBecomeReady(_ carrier: Carrier) {}
+    }
+
+    /// Create an empty persistent location under the temporary directory.
+    static func makeLocation() -> String {
+        let location = (NSTemporaryDirectory() as NSString)
+            .appendingPathComponent("carrier-\(UUID().uuidString)")
+        try! FileManager.default.createDirectory(atPath: location,
+                                                 withIntermediateDirectories: true)
+        return location
+    }
+
+    static func options(_ location: String) -> CarrierOptions {
+        let node = BootstrapNode()
+        node.ipv4 = "127.0.0.1"
+        node.port = "33445"
+        node.publicKey = Base58.encode([UInt8](repeating: 1, count: 32))
+
+        let options = CarrierOptions()
+        options.persistentLocation = location
+        options.udpEnabled = true
+        options.bootstrapNodes = [node]
+        return options
+    }
+
+    static func create(_ location: String) throws -> Carrier {
+        return try Carrier.createInstance(options: options(location),
+                                          delegate: Delegate())
+    }
+
+    /// The process CPU time used so far, user and system, in seconds.
+    static func cpuTime() -> TimeInterval {
+        var usage = rusage()
+        getrusage(RUSAGE_SELF, &usage)
+
+        let seconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+        let micros = usage.ru_utime.tv_usec + usage.ru_stime.tv_usec
+        return TimeInterval(seconds) + TimeInterval(micros) / 1e6
+    }
+
+    /// The percentile of the samples, by nearest rank.
+    static func percentile(_ samples: [TimeInterval], _ p: Double) -> TimeInterval {
+        let sorted = samples.sorted()
+        let rank = Int((p / 100 * Double(sorted.count)).rounded(.up))
+        return sorted[max(0, min(sorted.count - 1, rank - 1))]
+    }
+}
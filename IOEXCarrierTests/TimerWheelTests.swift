@@ -0,0 +1,100 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class TimerWheelTests: XCTestCase {
+
+    /// Turn the wheel until the condition holds or the timeout runs out.
+    private func advance(_ wheel: TimerWheel, timeout: TimeInterval = 2,
+                         until condition: () -> Bool) {
+        let deadline = Date().addingTimeInterval(timeout)
+        while !condition() && Date() < deadline {
+            Thread.sleep(forTimeInterval: 0.001)
+            wheel.advance()
+        }
+    }
+
+    func testTicksRoundUpAndClamp() {
+        let wheel = TimerWheel(resolution: 10)
+
+        XCTAssertEqual(wheel.ticks(for: 0), 1)
+        XCTAssertEqual(wheel.ticks(for: 10), 1)
+        XCTAssertEqual(wheel.ticks(for: 11), 2)
+        XCTAssertEqual(wheel.ticks(for: UInt64.max / 2), (1 << 24) - 1)
+        XCTAssertEqual(wheel.ticks(for: wheel.maxMilliseconds), (1 << 24) - 1)
+        XCTAssertEqual(wheel.maxMilliseconds, ((1 << 24) - 1) * 10)
+    }
+
+    func testTimersFireInDeadlineOrder() {
+        let wheel = TimerWheel(resolution: 1)
+        var fired = [UInt64]()
+
+        for interval: UInt64 in [30, 5, 100, 15] {
+            wheel.add(CarrierTimer(nil, interval, false) { _ in fired.append(interval) })
+        }
+        XCTAssertEqual(wheel.count, 4)
+
+        advance(wheel) { fired.count == 4 }
+        XCTAssertEqual(fired, [5, 15, 30, 100])
+        XCTAssertEqual(wheel.count, 0)
+        XCTAssertNil(wheel.millisecondsToNextExpiration())
+    }
+
+    func testTimerBeyondLowestLevelCascades() {
+        let wheel = TimerWheel(resolution: 1)
+        var fired = false
+        let start = Date()
+
+        wheel.add(CarrierTimer(nil, 200, false) { _ in fired = true })
+
+        advance(wheel) { fired }
+        XCTAssertTrue(fired)
+        XCTAssertGreaterThanOrEqual(Date().timeIntervalSince(start), 0.19)
+    }
+
+    func testRemovedAndCancelledTimersDoNotFire() {
+        let wheel = TimerWheel(resolution: 1)
+        var fired = [String]()
+
+        let removed = CarrierTimer(nil, 5, false) { _ in fired.append("removed") }
+        let cancelled = CarrierTimer(nil, 5, false) { _ in fired.append("cancelled") }
+        let kept = CarrierTimer(nil, 10, false) { _ in fired.append("kept") }
+
+        wheel.add(removed)
+        wheel.add(cancelled)
+        wheel.add(kept)
+        wheel.remove(removed)
+        cancelled.cancel()
+        XCTAssertEqual(wheel.count, 2)
+
+        advance(wheel) { wheel.count == 0 }
+        XCTAssertEqual(fired, ["kept"])
+    }
+
+    func testRepeatingTimerRunsUntilCancelled() {
+        let wheel = TimerWheel(resolution: 1)
+        var runs = 0
+
+        wheel.add(CarrierTimer(nil, 2, true) { (timer) in
+            runs += 1
+            if runs == 3 {
+                timer.cancel()
+            }
+        })
+
+        advance(wheel) { wheel.count == 0 }
+        XCTAssertEqual(runs, 3)
+    }
+
+    func testNextExpirationIsBoundedByLowestLevel() {
+        let wheel = TimerWheel(resolution: 10)
+        XCTAssertNil(wheel.millisecondsToNextExpiration())
+
+        wheel.add(CarrierTimer(nil, 30, false, nil))
+        XCTAssertLessThanOrEqual(wheel.millisecondsToNextExpiration()!, 30)
+
+        let far = TimerWheel(resolution: 10)
+        far.add(CarrierTimer(nil, 60_000, false, nil))
+        XCTAssertEqual(far.millisecondsToNextExpiration(), 640)
+    }
+}
@@ -0,0 +1,60 @@
+import XCTest
+@testable import IOEXCarrier
+
+/// Cost of traffic counting on the send and receive paths, and of
+/// scraping a snapshot while the counters are being updated.
+class TrafficCountersBenchmarkTests: XCTestCase {
+
+    private static let FRIENDS: Int = 5_000
+    private static let UPDATES: Int = 1_000_000
+
+    private var table: FriendTable!
+    private var counters: TrafficCounters!
+    private var handles = [Int]()
+
+    override func setUp() {
+        super.setUp()
+        table = FriendTable()
+        counters = TrafficCounters(table)
+        handles = (0..<TrafficCountersBenchmarkTests.FRIENDS).map {
+            table.intern("friend-\($0)")
+        }
+    }
+
+    func testMessageCounting() {
+        measure {
+            for index in 0..<TrafficCountersBenchmarkTests.UPDATES {
+                let handle = handles[index % handles.count]
+                if index & 1 == 0 {
+                    counters.didSend(handle, 128)
+                } else {
+                    counters.didReceive(handle, 128)
+                }
+            }
+        }
+    }
+
+    func testSnapshotWhileCounting() {
+        for handle in handles {
+            counters.didSend(handle, 128)
+        }
+
+        let counters = self.counters!
+        let handles = self.handles
+        let counting = DispatchGroup()
+
+        DispatchQueue.global().async(group: counting) {
+            for index in 0..<(TrafficCountersBenchmarkTests.UPDATES * 10) {
+                counters.didSend(handles[index % handles.count], 128)
+            }
+        }
+
+        measure {
+            for _ in 0..<10 {
+                XCTAssertEqual(counters.snapshot().friends.count, handles.count)
+            }
+        }
+
+        counting.wait()
+    }
+}
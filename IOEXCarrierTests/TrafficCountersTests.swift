@@ -0,0 +1,62 @@
+
+import XCTest
+@testable import IOEXCarrier
+
+class TrafficCountersTests: XCTestCase {
+
+    func testCountersAddUpPerFriendAndNode() {
+        let table = FriendTable()
+        let counters = TrafficCounters(table)
+        let alice = table.intern("alice")
+        let bob = table.intern("bob")
+
+        counters.didSend(alice, 10)
+        counters.didSend(alice, 5)
+        counters.didReceive(bob, 7)
+        counters.didSendInvite(bob)
+        counters.didTransferFile(alice, "file", 100)
+        counters.didTransferFile(alice, "file", 250)
+
+        let snapshot = counters.snapshot()
+        XCTAssertEqual(snapshot.node.messagesSent, 2)
+        XCTAssertEqual(snapshot.node.bytesSent, 15)
+        XCTAssertEqual(snapshot.node.bytesReceived, 7)
+        XCTAssertEqual(snapshot.node.fileBytes, 250)
+
+        XCTAssertEqual(snapshot.friends.count, 2)
+        XCTAssertEqual(snapshot.friends["alice"]!.bytesSent, 15)
+        XCTAssertEqual(snapshot.friends["alice"]!.fileBytes, 250)
+        XCTAssertEqual(snapshot.friends["bob"]!.messagesReceived, 1)
+        XCTAssertEqual(snapshot.friends["bob"]!.invitesSent, 1)
+    }
+
+    func testFailuresOfUnknownFriendsCountOnNodeOnly() {
+        let table = FriendTable()
+        let counters = TrafficCounters(table)
+        let alice = table.intern("alice")
+
+        counters.didFailToSend(alice, 0x25)
+        counters.didFailToSend(nil, 0x25)
+
+        let snapshot = counters.snapshot()
+        XCTAssertEqual(snapshot.node.sendFailures[0x25], 2)
+        XCTAssertEqual(snapshot.friends.count, 1)
+        XCTAssertEqual(snapshot.friends["alice"]!.sendFailures[0x25], 1)
+        XCTAssertEqual(snapshot.friends["alice"]!.messagesSent, 0)
+    }
+
+    func testHandlesAcrossChunksAreCounted() {
+        let table = FriendTable()
+        let counters = TrafficCounters(table)
+
+        var last = 0
+        for i in 0..<300 {
+            last = table.intern("friend\(i)")
+        }
+        counters.didReceive(last, 3)
+
+        let snapshot = counters.snapshot()
+        XCTAssertEqual(snapshot.friends.count, 1)
+        XCTAssertEqual(snapshot.friends["friend299"]!.bytesReceived, 3)
+    }
+}
@@ -1267,7 +1267,7 @@ internal func IOEX_remove_friend(_ carrier: OpaquePointer!,
 @_silgen_name("IOEX_send_friend_message")
 internal func IOEX_send_friend_message(_ carrier: OpaquePointer!,
                                       _ to: UnsafePointer<Int8>!,
-                                      _ msg: UnsafePointer<Int8>!,
+                                      _ msg: UnsafeRawPointer!,
                                       _ len: Int) -> Int32
 
 /**
@@ -1437,7 +1437,7 @@ internal func IOEX_send_file_request(_ carrier: OpaquePointer!,
                                        fileid: UnsafeMutablePointer<Int8>!,
                                        id_len: Int,
                                        friendid: UnsafePointer<Int8>!,
-                                       filename: UnsafePointer<Int8>!) -> UnsafeMutablePointer<Int8>!
+                                       filename: UnsafePointer<Int8>!) -> Int32
 
 /**
  * \~English
@@ -1611,3 +1611,24 @@ internal func IOEX_get_error() -> Int32
  */
 @_silgen_name("IOEX_clear_error")
 internal func IOEX_clear_error()
+
+/**
+ * \~English
+ * Carrier error facility and codes, with the same values defined in
+ * IOEX_carrier.h. The error code returned by getErrorCode() is composed
+ * of facility and code with IOEX_GENERAL_ERROR().
+ */
+internal let IOEXF_GENERAL: Int = 0x01
+
+internal let IOEXERR_INVALID_ARGS: Int = 0x01
+internal let IOEXERR_NOT_EXIST: Int = 0x0B
+internal let IOEXERR_ALREADY_EXIST: Int = 0x0C
+internal let IOEXERR_WRONG_STATE: Int = 0x12
+internal let IOEXERR_BUSY: Int = 0x13
+internal let IOEXERR_LIMIT_EXCEEDED: Int = 0x19
+internal let IOEXERR_TOO_LONG: Int = 0x22
+internal let IOEXERR_FRIEND_OFFLINE: Int = 0x25
+
+@inline(__always) internal func IOEX_GENERAL_ERROR(_ code: Int) -> Int {
+    return (IOEXF_GENERAL << 24) | code
+}